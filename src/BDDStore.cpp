@@ -0,0 +1,264 @@
+/**
+ * @file BDDStore.cpp
+ * @brief Writer and mmap-based reader of the read-only BDD store format.
+ */
+#include "BDDStore.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace ClassProject {
+
+    namespace {
+        const char STORE_MAGIC[8] = {'V', 'D', 'S', 'M', 'A', 'P', '0', '1'};
+        const uint32_t STORE_BYTE_ORDER = 0x01020304;
+        const uint32_t NO_VAR = std::numeric_limits<uint32_t>::max();
+
+        uint64_t alignUp(uint64_t offset) {
+            return (offset + 7) & ~uint64_t(7);
+        }
+
+        /* Whether count entries of the given size fit between an aligned offset and
+           the end of the file; written so that no product or sum can overflow */
+        bool sectionFits(uint64_t offset, uint64_t count, uint64_t entrySize, uint64_t length) {
+            return offset <= length && offset % 8 == 0 && count <= (length - offset) / entrySize;
+        }
+
+        bool nameFits(uint64_t offset, uint64_t nameLength, uint64_t namesSize) {
+            return offset <= namesSize && nameLength <= namesSize - offset;
+        }
+    }
+
+    /* All sections start 8-byte aligned; offsets are relative to the file start */
+    struct BDDStore::Header {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t varCount;
+        uint64_t nodeCount;
+        uint64_t rootCount;
+        uint64_t varsOffset;
+        uint64_t nodesOffset;
+        uint64_t rootsOffset;
+        uint64_t namesOffset;
+        uint64_t fileSize;
+    };
+
+    struct BDDStore::VarEntry {
+        uint64_t nameOffset;
+        uint64_t nameLength;
+    };
+
+    struct BDDStore::NodeEntry {
+        uint32_t var;
+        uint32_t low;
+        uint32_t high;
+    };
+
+    /* Sorted by name, so lookups are a binary search over the mapping */
+    struct BDDStore::RootEntry {
+        uint64_t nameOffset;
+        uint32_t nameLength;
+        uint32_t node;
+    };
+
+    void BDDStore::write(ManagerInterface &manager, const std::map<std::string, BDD_ID> &roots,
+                         const std::string &filepath) {
+        std::unordered_map<BDD_ID, Ref> index{{manager.False(), 0}, {manager.True(), 1}};
+        std::vector<BDD_ID> order;
+        std::map<BDD_ID, uint32_t> varIndex;
+
+        std::vector<BDD_ID> stack;
+        for (const auto &root : roots) {
+            stack.push_back(root.second);
+            while (!stack.empty()) {
+                BDD_ID id = stack.back();
+                if (index.count(id)) {
+                    stack.pop_back();
+                    continue;
+                }
+                BDD_ID high = manager.coFactorTrue(id);
+                BDD_ID low = manager.coFactorFalse(id);
+                bool childrenDone = true;
+                if (!index.count(high)) {
+                    stack.push_back(high);
+                    childrenDone = false;
+                }
+                if (!index.count(low)) {
+                    stack.push_back(low);
+                    childrenDone = false;
+                }
+                if (childrenDone) {
+                    stack.pop_back();
+                    if (order.size() + 2 >= NO_VAR)
+                        throw std::runtime_error("BDDStore::write: too many nodes for the store format");
+                    index[id] = static_cast<Ref>(order.size() + 2);
+                    order.push_back(id);
+                    varIndex[manager.topVar(id)] = 0;
+                }
+            }
+        }
+
+        std::string nameBlob;
+        std::vector<VarEntry> varEntries;
+        uint32_t nextVar = 0;
+        for (auto &var : varIndex) {
+            var.second = nextVar++;
+            std::string name = manager.getTopVarName(var.first);
+            varEntries.push_back({nameBlob.size(), name.size()});
+            nameBlob += name;
+        }
+
+        std::vector<NodeEntry> nodeEntries{{NO_VAR, 0, 0}, {NO_VAR, 1, 1}};
+        for (BDD_ID id : order) {
+            nodeEntries.push_back({varIndex[manager.topVar(id)],
+                                   index[manager.coFactorFalse(id)],
+                                   index[manager.coFactorTrue(id)]});
+        }
+
+        std::vector<RootEntry> rootEntries;
+        for (const auto &root : roots) {
+            rootEntries.push_back({nameBlob.size(), static_cast<uint32_t>(root.first.size()), index[root.second]});
+            nameBlob += root.first;
+        }
+
+        Header header{};
+        std::memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+        header.byteOrder = STORE_BYTE_ORDER;
+        header.varCount = static_cast<uint32_t>(varEntries.size());
+        header.nodeCount = nodeEntries.size();
+        header.rootCount = rootEntries.size();
+        header.varsOffset = alignUp(sizeof(Header));
+        header.nodesOffset = alignUp(header.varsOffset + varEntries.size() * sizeof(VarEntry));
+        header.rootsOffset = alignUp(header.nodesOffset + nodeEntries.size() * sizeof(NodeEntry));
+        header.namesOffset = alignUp(header.rootsOffset + rootEntries.size() * sizeof(RootEntry));
+        header.fileSize = header.namesOffset + nameBlob.size();
+
+        std::string out(header.fileSize, '\0');
+        std::memcpy(&out[0], &header, sizeof(Header));
+        std::memcpy(&out[header.varsOffset], varEntries.data(), varEntries.size() * sizeof(VarEntry));
+        std::memcpy(&out[header.nodesOffset], nodeEntries.data(), nodeEntries.size() * sizeof(NodeEntry));
+        std::memcpy(&out[header.rootsOffset], rootEntries.data(), rootEntries.size() * sizeof(RootEntry));
+        std::memcpy(&out[header.namesOffset], nameBlob.data(), nameBlob.size());
+
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("BDDStore::write: unable to open " + filepath);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) throw std::runtime_error("BDDStore::write: unable to write " + filepath);
+    }
+
+    BDDStore::BDDStore(const std::string &filepath) : file(filepath, false) {
+        const std::string invalid = "BDDStore: " + filepath + " is not a BDD store of this machine";
+        uint64_t length = file.size();
+        if (length < sizeof(Header)) throw std::runtime_error(invalid);
+        header = reinterpret_cast<const Header *>(file.begin());
+        if (std::memcmp(header->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 ||
+            header->byteOrder != STORE_BYTE_ORDER || header->fileSize != length ||
+            header->nodeCount < 2 || header->nodeCount > NO_VAR ||
+            !sectionFits(header->varsOffset, header->varCount, sizeof(VarEntry), length) ||
+            !sectionFits(header->nodesOffset, header->nodeCount, sizeof(NodeEntry), length) ||
+            !sectionFits(header->rootsOffset, header->rootCount, sizeof(RootEntry), length) ||
+            header->namesOffset > length) {
+            throw std::runtime_error(invalid);
+        }
+        vars = reinterpret_cast<const VarEntry *>(file.begin() + header->varsOffset);
+        nodes = reinterpret_cast<const NodeEntry *>(file.begin() + header->nodesOffset);
+        roots = reinterpret_cast<const RootEntry *>(file.begin() + header->rootsOffset);
+        names = file.begin() + header->namesOffset;
+
+        const std::string corrupt = "BDDStore: " + filepath + " is corrupt";
+        uint64_t namesSize = length - header->namesOffset;
+        for (size_t var = 0; var < header->varCount; ++var) {
+            if (!nameFits(vars[var].nameOffset, vars[var].nameLength, namesSize))
+                throw std::runtime_error(corrupt + ": name of variable " + std::to_string(var) + " out of range");
+        }
+        /* Children before parents also rules out cycles, so traversals end at a terminal */
+        for (uint64_t i = 2; i < header->nodeCount; ++i) {
+            const NodeEntry &node = nodes[i];
+            if (node.var >= header->varCount || node.low >= i || node.high >= i)
+                throw std::runtime_error(corrupt + ": node " + std::to_string(i) + " out of range");
+        }
+        for (size_t i = 0; i < header->rootCount; ++i) {
+            if (roots[i].node >= header->nodeCount || !nameFits(roots[i].nameOffset, roots[i].nameLength, namesSize) ||
+                (i > 0 && !(rootName(i - 1) < rootName(i))))
+                throw std::runtime_error(corrupt + ": root " + std::to_string(i) + " out of range or order");
+        }
+    }
+
+    size_t BDDStore::nodeCount() const { return header->nodeCount; }
+
+    size_t BDDStore::varCount() const { return header->varCount; }
+
+    std::string_view BDDStore::varName(size_t var) const {
+        return {names + vars[var].nameOffset, vars[var].nameLength};
+    }
+
+    std::string_view BDDStore::rootName(size_t i) const {
+        return {names + roots[i].nameOffset, roots[i].nameLength};
+    }
+
+    BDDStore::Ref BDDStore::root(std::string_view name) const {
+        size_t first = 0, last = header->rootCount;
+        while (first < last) {
+            size_t mid = first + (last - first) / 2;
+            if (rootName(mid) < name) first = mid + 1;
+            else last = mid;
+        }
+        if (first == header->rootCount || rootName(first) != name)
+            throw std::runtime_error("BDDStore: no root named " + std::string(name));
+        return roots[first].node;
+    }
+
+    std::vector<std::string_view> BDDStore::rootNames() const {
+        std::vector<std::string_view> result;
+        for (size_t i = 0; i < header->rootCount; ++i) result.push_back(rootName(i));
+        return result;
+    }
+
+    bool BDDStore::isConstant(Ref f) const { return f < 2; }
+
+    size_t BDDStore::topVar(Ref f) const {
+        return isConstant(f) ? header->varCount : nodes[f].var;
+    }
+
+    BDDStore::Ref BDDStore::coFactorTrue(Ref f) const { return nodes[f].high; }
+
+    BDDStore::Ref BDDStore::coFactorFalse(Ref f) const { return nodes[f].low; }
+
+    bool BDDStore::evaluate(Ref f, const std::vector<bool> &assignment) const {
+        while (!isConstant(f)) {
+            const NodeEntry &node = nodes[f];
+            f = assignment.at(node.var) ? node.high : node.low;
+        }
+        return f == 1;
+    }
+
+    double BDDStore::satCount(Ref f) const {
+        /* Post-order over the nodes reachable from f, computing the fraction
+           of satisfying assignments of each once both children have one */
+        std::unordered_map<Ref, double> fraction{{0, 0.0}, {1, 1.0}};
+        std::vector<Ref> stack{f};
+        while (!stack.empty()) {
+            Ref node = stack.back();
+            if (fraction.count(node)) {
+                stack.pop_back();
+                continue;
+            }
+            auto low = fraction.find(nodes[node].low);
+            auto high = fraction.find(nodes[node].high);
+            if (low != fraction.end() && high != fraction.end()) {
+                double value = (low->second + high->second) / 2;
+                fraction.emplace(node, value);
+                stack.pop_back();
+                continue;
+            }
+            if (low == fraction.end()) stack.push_back(nodes[node].low);
+            if (high == fraction.end()) stack.push_back(nodes[node].high);
+        }
+        return std::ldexp(fraction.at(f), static_cast<int>(header->varCount));
+    }
+
+}
@@ -0,0 +1,98 @@
+// Read-only, memory-mapped BDD store
+//
+// The file is laid out so it can be queried in place: once mapped, every
+// process reading the same file shares one page-cache copy and no node is
+// ever copied into a Manager.
+
+#ifndef VDSPROJECT_BDDSTORE_H
+#define VDSPROJECT_BDDSTORE_H
+
+#include "ManagerInterface.h"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ClassProject {
+
+    /**
+     * @brief Immutable BDD file that is queried directly through mmap.
+     *
+     * Node references are indices into the node array of the store, not IDs
+     * of the Manager that wrote it. Index 0 and 1 are the terminals and every
+     * node is stored after both of its children. Variables are numbered by
+     * their position in the variable order of the writing Manager.
+     * The file uses the byte order of the machine that wrote it.
+     */
+    class BDDStore {
+    public:
+        typedef uint32_t Ref;
+
+        /**
+         * @brief Writes the BDDs of the named roots in store layout.
+         */
+        static void write(ManagerInterface &manager, const std::map<std::string, BDD_ID> &roots,
+                          const std::string &filepath);
+
+        /**
+         * @brief Maps the store read-only and validates it.
+         *
+         * Throws std::runtime_error unless every section, name and child lies
+         * inside the file and every node comes after its children, so no query
+         * on a root of the store can read outside the mapping. Validation reads
+         * the node array once.
+         */
+        explicit BDDStore(const std::string &filepath);
+
+        BDDStore(const BDDStore &) = delete;
+        BDDStore &operator=(const BDDStore &) = delete;
+
+        size_t nodeCount() const;
+        size_t varCount() const;
+        std::string_view varName(size_t var) const;
+
+        /**
+         * @brief Returns the node of the root with the given name; throws if unknown.
+         */
+        Ref root(std::string_view name) const;
+        std::vector<std::string_view> rootNames() const;
+
+        bool isConstant(Ref f) const;
+        /// Variable index of the top variable of f (varCount() for terminals)
+        size_t topVar(Ref f) const;
+        Ref coFactorTrue(Ref f) const;
+        Ref coFactorFalse(Ref f) const;
+
+        /**
+         * @brief Evaluates f under an assignment indexed by variable index.
+         */
+        bool evaluate(Ref f, const std::vector<bool> &assignment) const;
+
+        /**
+         * @brief Number of satisfying assignments of f over all variables of the store.
+         *
+         * Visits only the nodes reachable from f.
+         */
+        double satCount(Ref f) const;
+
+    private:
+        struct Header;
+        struct VarEntry;
+        struct NodeEntry;
+        struct RootEntry;
+
+        MappedFile file;
+        const Header *header;
+        const VarEntry *vars;
+        const NodeEntry *nodes;
+        const RootEntry *roots;
+        const char *names;
+
+        std::string_view rootName(size_t i) const;
+    };
+
+}
+
+#endif
@@ -13,17 +13,90 @@
 #include <fstream>
 #include <functional>
 #include <unordered_map>  // Added for hash-based table
+#include <stdexcept>
+#include <iterator>
+#include <cstdint>
+#include <algorithm>
 
 
 namespace ClassProject {
 
+    namespace {
+
+        const char BDD_FILE_MAGIC[8] = {'V', 'D', 'S', 'B', 'D', 'D', '0', '1'};
+        const char CHECKPOINT_MAGIC[8] = {'V', 'D', 'S', 'C', 'K', 'P', '0', '1'};
+
+        /// Top variable of a unique table slot freed by collectGarbage
+        const BDD_ID FREE_NODE = std::numeric_limits<BDD_ID>::max();
+
+        /// Fixed-size header of a checkpoint, followed by the blocks it counts
+        struct CheckpointHeader {
+            char magic[8];
+            uint64_t nodeSize;      ///< sizeof(Node) of the writer, guards against foreign builds
+            uint64_t nodeCount;
+            uint64_t varCount;
+            uint64_t labelBytes;
+            uint64_t computedCount;
+        };
+
+        template<typename T>
+        void writeBlock(std::ofstream &out, const T *data, size_t count) {
+            out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        }
+
+        template<typename T>
+        void readBlock(std::ifstream &in, T *data, size_t count, const std::string &filepath) {
+            if (!in.read(reinterpret_cast<char *>(data), static_cast<std::streamsize>(count * sizeof(T))))
+                throw std::runtime_error("Manager::restore: " + filepath + " is truncated");
+        }
+
+        void putVarint(std::string &out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        void putString(std::string &out, const std::string &str) {
+            putVarint(out, str.size());
+            out.append(str);
+        }
+
+        /// Cursor over the bytes of a BDD file; throws on truncated input.
+        struct ByteReader {
+            const char *pos;
+            const char *end;
+
+            uint64_t varint() {
+                uint64_t value = 0;
+                for (unsigned shift = 0; shift < 64; shift += 7) {
+                    if (pos == end) throw std::runtime_error("Manager::load: unexpected end of file");
+                    auto byte = static_cast<unsigned char>(*pos++);
+                    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if (!(byte & 0x80)) return value;
+                }
+                throw std::runtime_error("Manager::load: malformed varint");
+            }
+
+            std::string string() {
+                uint64_t len = varint();
+                if (static_cast<uint64_t>(end - pos) < len)
+                    throw std::runtime_error("Manager::load: unexpected end of file");
+                std::string str(pos, len);
+                pos += len;
+                return str;
+            }
+        };
+
+    }
+
     Manager::Manager():
-        currentID(2),
         trueID(1),
         falseID(0)
     {
-        uniqueTable[falseID] = {falseID, falseID, falseID, falseID};
-        uniqueTable[trueID] = {trueID, trueID, trueID, trueID};
+        uniqueTable.push_back({falseID, falseID, falseID, falseID});
+        uniqueTable.push_back({trueID, trueID, trueID, trueID});
     }
 
     const BDD_ID &Manager::True() { return trueID; }
@@ -32,17 +105,18 @@ namespace ClassProject {
     bool Manager::isConstant(BDD_ID f) { return f == falseID || f == trueID; }
 
     bool Manager::isVariable(BDD_ID x) {
-        return variableIDs.count(x) > 0;
+        /* Only variables and the terminals are their own top variable */
+        return !isConstant(x) && x < uniqueTable.size() && uniqueTable[x].topVar == x;
     }
 
     BDD_ID Manager::createVar(const std::string &label) {
         if (labelToID.count(label)) return labelToID[label];
-        BDD_ID id = currentID++;
+        BDD_ID id = uniqueTable.size();
         labelToID[label] = id;
         idToLabel[id] = label;
-        variableIDs.insert(id);
-        uniqueTable[id] = {id, id, falseID, trueID};
+        uniqueTable.push_back({id, id, falseID, trueID});
         uniqueHashTable[std::make_tuple(id, falseID, trueID)] = id;
+        peakLiveNodes = std::max(peakLiveNodes, liveNodeCount());
         return id;
     }
 
@@ -60,6 +134,9 @@ namespace ClassProject {
 
         if (f == x && isVariable(x)) return True();
 
+        /* Variables are ordered by ID, so f does not depend on a variable above its top */
+        if (topVar(f) > x) return f;
+
         if (topVar(f) == x) {
             return uniqueTable[f].high;
         } else {
@@ -79,6 +156,9 @@ namespace ClassProject {
 
         if (f == x && isVariable(x)) return False();
 
+        /* Variables are ordered by ID, so f does not depend on a variable above its top */
+        if (topVar(f) > x) return f;
+
         if (topVar(f) == x) {
             return uniqueTable[f].low;
         } else {
@@ -90,10 +170,23 @@ namespace ClassProject {
 
     BDD_ID Manager::addNode(BDD_ID v, BDD_ID h, BDD_ID l) {
         auto key = std::make_tuple(v, l, h);
-        if (uniqueHashTable.count(key)) return uniqueHashTable[key];
-        BDD_ID id = currentID++;
-        uniqueTable[id] = {id, v, l, h};
+        cacheStats.uniqueLookups++;
+        auto existing = uniqueHashTable.find(key);
+        if (existing != uniqueHashTable.end()) {
+            cacheStats.uniqueHits++;
+            return existing->second;
+        }
+        BDD_ID id;
+        if (freeIDs.empty()) {
+            id = uniqueTable.size();
+            uniqueTable.push_back({id, v, l, h});
+        } else {
+            id = freeIDs.back();
+            freeIDs.pop_back();
+            uniqueTable[id] = {id, v, l, h};
+        }
         uniqueHashTable[key] = id;
+        peakLiveNodes = std::max(peakLiveNodes, liveNodeCount());
         return id;
     }
 
@@ -102,7 +195,12 @@ namespace ClassProject {
         if (f == falseID) return h;
         if (g == h) return g;
         auto key = std::make_tuple(f, g, h);
-        if (computedTable.count(key)) return computedTable[key];
+        cacheStats.computedLookups++;
+        auto computed = computedTable.find(key);
+        if (computed != computedTable.end()) {
+            cacheStats.computedHits++;
+            return computed->second;
+        }
         BDD_ID top = std::numeric_limits<BDD_ID>::max();
         if (!isConstant(f)) top = std::min(top, topVar(f));
         if (!isConstant(g)) top = std::min(top, topVar(g));
@@ -144,7 +242,8 @@ namespace ClassProject {
 
     std::string Manager::getTopVarName(const BDD_ID &id) {
         if (isConstant(id)) return std::to_string(id);
-        return idToLabel.count(topVar(id)) ? idToLabel[topVar(id)] : "n" + std::to_string(topVar(id));
+        auto label = idToLabel.find(topVar(id));
+        return label != idToLabel.end() ? label->second : "n" + std::to_string(topVar(id));
     }
 
     void Manager::visualizeBDD(std::string filepath, BDD_ID &root) {
@@ -196,4 +295,396 @@ namespace ClassProject {
         return uniqueTable.size();
     }
 
-} // namespace ClassProject
\ No newline at end of file
+    RootAnalysis Manager::analyzeRoots(const std::vector<BDD_ID> &roots) {
+        RootAnalysis result;
+        for (const auto &var : idToLabel) result.variables.push_back(var.first);
+        result.nodeCounts.assign(roots.size(), 0);
+        result.supports.assign(roots.size(), std::vector<uint64_t>((result.variables.size() + 63) / 64, 0));
+
+        if (++visitGeneration == 0) {
+            std::fill(visitStamp.begin(), visitStamp.end(), 0);
+            visitGeneration = 1;
+        }
+        visitStamp.resize(uniqueTable.size(), 0);
+        visitSlot.resize(uniqueTable.size());
+
+        /* Post-order over all roots, children before parents. A node is stamped
+           when it is expanded and gets its slot once its children have one. */
+        std::vector<BDD_ID> order;
+        std::vector<std::pair<BDD_ID, bool>> stack;
+        for (BDD_ID root : roots) {
+            stack.emplace_back(root, false);
+            while (!stack.empty()) {
+                auto [id, expanded] = stack.back();
+                stack.pop_back();
+                if (expanded) {
+                    visitSlot[id] = static_cast<uint32_t>(order.size());
+                    order.push_back(id);
+                    continue;
+                }
+                if (visitStamp[id] == visitGeneration) continue;
+                visitStamp[id] = visitGeneration;
+                stack.emplace_back(id, true);
+                if (!isConstant(id)) {
+                    if (visitStamp[uniqueTable[id].high] != visitGeneration) stack.emplace_back(uniqueTable[id].high, false);
+                    if (visitStamp[uniqueTable[id].low] != visitGeneration) stack.emplace_back(uniqueTable[id].low, false);
+                }
+            }
+        }
+        result.sharedNodeCount = order.size();
+
+        /* Position of each node's top variable in the variable order */
+        std::vector<uint32_t> varOfSlot(order.size());
+        for (size_t slot = 0; slot < order.size(); ++slot) {
+            if (isConstant(order[slot])) continue;
+            auto var = std::lower_bound(result.variables.begin(), result.variables.end(), uniqueTable[order[slot]].topVar);
+            varOfSlot[slot] = static_cast<uint32_t>(var - result.variables.begin());
+        }
+
+        const size_t batchRoots = 512;
+        std::vector<uint64_t> reached, varReached;
+        for (size_t first = 0; first < roots.size(); first += batchRoots) {
+            size_t count = std::min(batchRoots, roots.size() - first);
+            size_t words = (count + 63) / 64;
+            reached.assign(order.size() * words, 0);
+            varReached.assign(result.variables.size() * words, 0);
+            for (size_t r = 0; r < count; ++r) {
+                reached[visitSlot[roots[first + r]] * words + r / 64] |= uint64_t(1) << (r % 64);
+            }
+
+            /* Parents come after their children, so walk the order backwards */
+            for (size_t slot = order.size(); slot-- > 0;) {
+                const uint64_t *bits = &reached[slot * words];
+                for (size_t w = 0; w < words; ++w) {
+                    uint64_t word = bits[w];
+                    while (word) {
+                        result.nodeCounts[first + w * 64 + __builtin_ctzll(word)]++;
+                        word &= word - 1;
+                    }
+                }
+                if (isConstant(order[slot])) continue;
+                const Node &node = uniqueTable[order[slot]];
+                uint64_t *high = &reached[visitSlot[node.high] * words];
+                uint64_t *low = &reached[visitSlot[node.low] * words];
+                uint64_t *var = &varReached[varOfSlot[slot] * words];
+                for (size_t w = 0; w < words; ++w) {
+                    high[w] |= bits[w];
+                    low[w] |= bits[w];
+                    var[w] |= bits[w];
+                }
+            }
+
+            for (size_t v = 0; v < result.variables.size(); ++v) {
+                for (size_t w = 0; w < words; ++w) {
+                    uint64_t word = varReached[v * words + w];
+                    while (word) {
+                        result.supports[first + w * 64 + __builtin_ctzll(word)][v / 64] |= uint64_t(1) << (v % 64);
+                        word &= word - 1;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    size_t Manager::collectGarbage(const std::vector<BDD_ID> &roots) {
+        /* Mark everything reachable from the roots, the variables and the terminals */
+        std::vector<bool> live(uniqueTable.size(), false);
+        std::vector<BDD_ID> stack(roots.begin(), roots.end());
+        for (const auto &var : idToLabel) stack.push_back(var.first);
+        stack.push_back(falseID);
+        stack.push_back(trueID);
+        while (!stack.empty()) {
+            BDD_ID id = stack.back();
+            stack.pop_back();
+            if (live[id]) continue;
+            live[id] = true;
+            if (!isConstant(id)) {
+                stack.push_back(uniqueTable[id].high);
+                stack.push_back(uniqueTable[id].low);
+            }
+        }
+
+        size_t freed = 0;
+        for (BDD_ID id = 2; id < uniqueTable.size(); ++id) {
+            Node &node = uniqueTable[id];
+            if (live[id] || node.topVar == FREE_NODE) continue;
+            uniqueHashTable.erase(std::make_tuple(node.topVar, node.low, node.high));
+            node.topVar = FREE_NODE;
+            freeIDs.push_back(id);
+            freed++;
+        }
+        if (freed == 0) return 0;
+        /* Highest first, so that addNode reuses the lowest free IDs first */
+        std::sort(freeIDs.begin(), freeIDs.end(), std::greater<>());
+
+        for (auto entry = computedTable.begin(); entry != computedTable.end();) {
+            const auto &key = entry->first;
+            if (live[std::get<0>(key)] && live[std::get<1>(key)] && live[std::get<2>(key)] && live[entry->second]) {
+                ++entry;
+            } else {
+                entry = computedTable.erase(entry);
+            }
+        }
+        return freed;
+    }
+
+    size_t Manager::liveNodeCount() {
+        return uniqueTable.size() - freeIDs.size();
+    }
+
+    size_t Manager::peakLiveNodeCount() {
+        return peakLiveNodes;
+    }
+
+    /*
+     * File layout (all integers are LEB128 varints):
+     *   magic "VDSBDD01"
+     *   #vars, then per variable its name (length + bytes), sorted by variable order
+     *   #nodes, then per node: variable index, low ref, high ref
+     *   #roots, then per root: name, node index
+     * Node indices 0 and 1 are the terminals, inner nodes start at 2 in file order.
+     * A child ref of 0/1 names a terminal, otherwise ref - 1 is the distance
+     * back to the child, which is always written before its parent.
+     */
+    void Manager::save(const std::string &filepath, const std::map<std::string, BDD_ID> &roots) {
+        std::unordered_map<BDD_ID, uint64_t> fileIndex{{falseID, 0}, {trueID, 1}};
+        std::vector<BDD_ID> order;
+        std::map<BDD_ID, uint64_t> varIndex;
+
+        /* Iterative post-order DFS, so that shared nodes get a single index */
+        std::vector<BDD_ID> stack;
+        for (const auto &root : roots) {
+            stack.push_back(root.second);
+            while (!stack.empty()) {
+                BDD_ID id = stack.back();
+                if (fileIndex.count(id)) {
+                    stack.pop_back();
+                    continue;
+                }
+                const Node &node = uniqueTable.at(id);
+                bool childrenDone = true;
+                if (!fileIndex.count(node.high)) {
+                    stack.push_back(node.high);
+                    childrenDone = false;
+                }
+                if (!fileIndex.count(node.low)) {
+                    stack.push_back(node.low);
+                    childrenDone = false;
+                }
+                if (childrenDone) {
+                    stack.pop_back();
+                    fileIndex[id] = order.size() + 2;
+                    order.push_back(id);
+                    varIndex[node.topVar] = 0;
+                }
+            }
+        }
+
+        std::string out(BDD_FILE_MAGIC, sizeof(BDD_FILE_MAGIC));
+        putVarint(out, varIndex.size());
+        uint64_t nextVar = 0;
+        for (auto &var : varIndex) {
+            var.second = nextVar++;
+            putString(out, idToLabel.count(var.first) ? idToLabel[var.first] : "n" + std::to_string(var.first));
+        }
+
+        putVarint(out, order.size());
+        for (uint64_t i = 0; i < order.size(); ++i) {
+            const Node &node = uniqueTable.at(order[i]);
+            uint64_t self = i + 2;
+            uint64_t low = fileIndex[node.low];
+            uint64_t high = fileIndex[node.high];
+            putVarint(out, varIndex[node.topVar]);
+            putVarint(out, low < 2 ? low : self - low + 1);
+            putVarint(out, high < 2 ? high : self - high + 1);
+        }
+
+        putVarint(out, roots.size());
+        for (const auto &root : roots) {
+            putString(out, root.first);
+            putVarint(out, fileIndex[root.second]);
+        }
+
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Manager::save: unable to open " + filepath);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) throw std::runtime_error("Manager::save: unable to write " + filepath);
+    }
+
+    std::map<std::string, BDD_ID> Manager::load(const std::string &filepath) {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Manager::load: unable to open " + filepath);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (data.size() < sizeof(BDD_FILE_MAGIC) ||
+            data.compare(0, sizeof(BDD_FILE_MAGIC), BDD_FILE_MAGIC, sizeof(BDD_FILE_MAGIC)) != 0)
+            throw std::runtime_error("Manager::load: " + filepath + " is not a BDD file");
+        ByteReader in{data.data() + sizeof(BDD_FILE_MAGIC), data.data() + data.size()};
+
+        std::vector<BDD_ID> vars(in.varint());
+        for (auto &var : vars) var = createVar(in.string());
+
+        std::vector<BDD_ID> ids{falseID, trueID};
+        uint64_t nodeCount = in.varint();
+        ids.reserve(nodeCount + 2);
+        auto childRef = [&](uint64_t self, uint64_t ref) {
+            if (ref >= 2 && ref - 1 > self - 2)
+                throw std::runtime_error("Manager::load: node references a node not yet defined");
+            return ids[ref < 2 ? ref : self - (ref - 1)];
+        };
+        for (uint64_t self = 2; self < nodeCount + 2; ++self) {
+            uint64_t var = in.varint();
+            if (var >= vars.size()) throw std::runtime_error("Manager::load: variable index out of range");
+            BDD_ID low = childRef(self, in.varint());
+            BDD_ID high = childRef(self, in.varint());
+            BDD_ID top = vars[var];
+            /* The file is already reduced; only fall back to ite when this
+               manager orders the variables differently than the saving one */
+            bool ordered = (isConstant(low) || topVar(low) > top) && (isConstant(high) || topVar(high) > top);
+            ids.push_back(ordered ? addNode(top, high, low) : ite(top, high, low));
+        }
+
+        std::map<std::string, BDD_ID> roots;
+        uint64_t rootCount = in.varint();
+        for (uint64_t i = 0; i < rootCount; ++i) {
+            std::string name = in.string();
+            uint64_t index = in.varint();
+            if (index >= ids.size()) throw std::runtime_error("Manager::load: root index out of range");
+            roots[name] = ids[index];
+        }
+        return roots;
+    }
+
+    /*
+     * Checkpoint layout: CheckpointHeader, the node table, the variable IDs,
+     * the lengths of their labels, the concatenated labels and finally the
+     * computed table as (f, g, h, result) quadruples.
+     */
+    void Manager::checkpoint(const std::string &filepath, bool withComputedTable) {
+        std::vector<BDD_ID> varIDs;
+        std::vector<uint64_t> labelLengths;
+        std::string labels;
+        varIDs.reserve(idToLabel.size());
+        labelLengths.reserve(idToLabel.size());
+        for (const auto &var : idToLabel) {
+            varIDs.push_back(var.first);
+            labelLengths.push_back(var.second.size());
+            labels += var.second;
+        }
+
+        std::vector<BDD_ID> computed;
+        if (withComputedTable) {
+            computed.reserve(4 * computedTable.size());
+            for (const auto &entry : computedTable) {
+                computed.insert(computed.end(), {std::get<0>(entry.first), std::get<1>(entry.first),
+                                                 std::get<2>(entry.first), entry.second});
+            }
+        }
+
+        CheckpointHeader header{};
+        std::copy(std::begin(CHECKPOINT_MAGIC), std::end(CHECKPOINT_MAGIC), header.magic);
+        header.nodeSize = sizeof(Node);
+        header.nodeCount = uniqueTable.size();
+        header.varCount = varIDs.size();
+        header.labelBytes = labels.size();
+        header.computedCount = computed.size() / 4;
+
+        std::ofstream out(filepath, std::ios::binary);
+        if (!out.is_open()) throw std::runtime_error("Manager::checkpoint: unable to open " + filepath);
+        writeBlock(out, &header, 1);
+        writeBlock(out, uniqueTable.data(), uniqueTable.size());
+        writeBlock(out, varIDs.data(), varIDs.size());
+        writeBlock(out, labelLengths.data(), labelLengths.size());
+        writeBlock(out, labels.data(), labels.size());
+        writeBlock(out, computed.data(), computed.size());
+        if (!out) throw std::runtime_error("Manager::checkpoint: unable to write " + filepath);
+    }
+
+    void Manager::restore(const std::string &filepath) {
+        std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) throw std::runtime_error("Manager::restore: unable to open " + filepath);
+        std::streamoff end = in.tellg();
+        if (end < 0) throw std::runtime_error("Manager::restore: unable to read " + filepath);
+        auto fileSize = static_cast<uint64_t>(end);
+        in.seekg(0);
+
+        const std::string corrupt = "Manager::restore: " + filepath + " is truncated or corrupt";
+        CheckpointHeader header{};
+        readBlock(in, &header, 1, filepath);
+        if (!std::equal(std::begin(CHECKPOINT_MAGIC), std::end(CHECKPOINT_MAGIC), header.magic) ||
+            header.nodeSize != sizeof(Node) || header.nodeCount < 2)
+            throw std::runtime_error("Manager::restore: " + filepath + " is not a checkpoint of this build");
+
+        /* Every count is checked against the bytes left before anything is
+           allocated, by division so that no product can overflow */
+        uint64_t remaining = fileSize - sizeof(CheckpointHeader);
+        auto take = [&](uint64_t count, uint64_t entrySize) {
+            if (count > remaining / entrySize) throw std::runtime_error(corrupt);
+            remaining -= count * entrySize;
+        };
+        take(header.nodeCount, sizeof(Node));
+        take(header.varCount, sizeof(BDD_ID) + sizeof(uint64_t));
+        take(header.labelBytes, 1);
+        take(header.computedCount, 4 * sizeof(BDD_ID));
+        if (remaining != 0) throw std::runtime_error(corrupt);
+
+        std::vector<Node> nodes(header.nodeCount);
+        std::vector<BDD_ID> varIDs(header.varCount);
+        std::vector<uint64_t> labelLengths(header.varCount);
+        std::string labels(header.labelBytes, '\0');
+        std::vector<BDD_ID> computed(4 * header.computedCount);
+        readBlock(in, nodes.data(), nodes.size(), filepath);
+        readBlock(in, varIDs.data(), varIDs.size(), filepath);
+        readBlock(in, labelLengths.data(), labelLengths.size(), filepath);
+        readBlock(in, &labels[0], labels.size(), filepath);
+        readBlock(in, computed.data(), computed.size(), filepath);
+
+        /* Everything is rebuilt in locals and only swapped in once the whole
+           file has been checked, so a throw leaves the manager untouched */
+        auto inRange = [&](BDD_ID id) { return id < nodes.size(); };
+        std::map<std::string, BDD_ID> restoredLabelToID;
+        std::map<BDD_ID, std::string> restoredIDToLabel;
+        size_t offset = 0;
+        for (size_t i = 0; i < varIDs.size(); ++i) {
+            if (labelLengths[i] > labels.size() - offset || !inRange(varIDs[i]))
+                throw std::runtime_error(corrupt);
+            std::string label = labels.substr(offset, labelLengths[i]);
+            offset += labelLengths[i];
+            restoredLabelToID[label] = varIDs[i];
+            restoredIDToLabel[varIDs[i]] = std::move(label);
+        }
+
+        /* The hash tables are not stored, they are rebuilt from the node table */
+        std::unordered_map<std::tuple<BDD_ID, BDD_ID, BDD_ID>, BDD_ID, TupleHash> restoredUniqueHash;
+        restoredUniqueHash.reserve(nodes.size());
+        std::vector<BDD_ID> restoredFreeIDs;
+        for (size_t id = nodes.size(); id-- > 2;) {
+            const Node &node = nodes[id];
+            if (node.topVar == FREE_NODE) {
+                restoredFreeIDs.push_back(id);
+                continue;
+            }
+            if (!inRange(node.topVar) || !inRange(node.low) || !inRange(node.high))
+                throw std::runtime_error(corrupt);
+            restoredUniqueHash[std::make_tuple(node.topVar, node.low, node.high)] = id;
+        }
+        std::unordered_map<std::tuple<BDD_ID, BDD_ID, BDD_ID>, BDD_ID, TupleHash> restoredComputed;
+        restoredComputed.reserve(header.computedCount);
+        for (size_t i = 0; i < computed.size(); i += 4) {
+            if (!inRange(computed[i]) || !inRange(computed[i + 1]) || !inRange(computed[i + 2]) ||
+                !inRange(computed[i + 3]))
+                throw std::runtime_error(corrupt);
+            restoredComputed[std::make_tuple(computed[i], computed[i + 1], computed[i + 2])] = computed[i + 3];
+        }
+
+        uniqueTable.swap(nodes);
+        labelToID.swap(restoredLabelToID);
+        idToLabel.swap(restoredIDToLabel);
+        uniqueHashTable.swap(restoredUniqueHash);
+        freeIDs.swap(restoredFreeIDs);
+        computedTable.swap(restoredComputed);
+        peakLiveNodes = liveNodeCount();
+    }
+
+} // namespace ClassProject
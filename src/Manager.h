@@ -11,6 +11,7 @@
 #include <string>
 #include <tuple>
 #include <set>
+#include <vector>
 
 namespace ClassProject {
 
@@ -26,6 +27,16 @@ namespace ClassProject {
 
     class Manager : public ManagerInterface {
     public:
+        /**
+         * @brief Lookups in the computed table by ite and in the unique table by addNode.
+         */
+        struct CacheStatistics {
+            uint64_t computedLookups = 0;
+            uint64_t computedHits = 0;
+            uint64_t uniqueLookups = 0;
+            uint64_t uniqueHits = 0;
+        };
+
         Manager();
 
         BDD_ID createVar(const std::string &label) override;
@@ -47,26 +58,110 @@ namespace ClassProject {
         BDD_ID nor2(BDD_ID a, BDD_ID b) override;
         BDD_ID xnor2(BDD_ID a, BDD_ID b) override;
 
+        /**
+         * @brief Name of the top variable of root.
+         *
+         * Like isConstant, topVar, coFactorTrue/False, findNodes and findVars
+         * it only reads the manager, so several threads may call these
+         * queries at once as long as no thread modifies the manager.
+         */
         std::string getTopVarName(const BDD_ID &root) override;
         void findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) override;
         void findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root) override;
         size_t uniqueTableSize() override;
+
+        /**
+         * @brief Node counts and supports of several roots in one traversal.
+         *
+         * Nodes shared by several roots are visited once: a post-order pass
+         * over all roots stamps the visited nodes, then each node hands a
+         * bitset of the roots reaching it down to its children. Roots are
+         * processed in batches of at most 512, bounding the bitsets to 8 words
+         * per node. Unlike findNodes it updates the visit stamps, so it must
+         * not run concurrently with other queries.
+         */
+        RootAnalysis analyzeRoots(const std::vector<BDD_ID> &roots) override;
         void visualizeBDD(std::string filepath, BDD_ID &root) override;
 
+        /**
+         * @brief Frees every node not reachable from the given roots.
+         *
+         * Variables and terminals are always kept. IDs of freed nodes are
+         * handed out again by later operations, and computed table entries
+         * involving a freed node are dropped. Variables are never reused,
+         * so the variable order is the same as without collection.
+         * @return the number of nodes freed
+         */
+        size_t collectGarbage(const std::vector<BDD_ID> &roots) override;
+
+        /**
+         * @brief Number of nodes in the unique table, terminals included, minus freed ones.
+         */
+        size_t liveNodeCount() override;
+
+        /**
+         * @brief Highest liveNodeCount() since the manager was created or restored.
+         */
+        size_t peakLiveNodeCount() override;
+
+        /**
+         * @brief Table lookups since the manager was created; not saved in checkpoints.
+         */
+        const CacheStatistics &cacheStatistics() const { return cacheStats; }
+
+        /**
+         * @brief Writes the BDDs of the named roots to a compact binary file.
+         *
+         * Nodes shared between roots are written once, children before parents.
+         * The variable names are stored in a header and child references are
+         * varint-encoded deltas to the referencing node.
+         */
+        void save(const std::string &filepath, const std::map<std::string, BDD_ID> &roots);
+
+        /**
+         * @brief Rebuilds the BDDs of a file written by save() in this manager.
+         *
+         * Variables are matched by name; missing ones are created in the order
+         * of the file header.
+         * @return the named roots with their IDs in this manager
+         */
+        std::map<std::string, BDD_ID> load(const std::string &filepath);
+
+        /**
+         * @brief Writes the complete manager state to a checkpoint file.
+         *
+         * The node table, the variable labels and, optionally, the computed
+         * table are written as contiguous binary blocks of this machine.
+         */
+        void checkpoint(const std::string &filepath, bool withComputedTable = false);
+
+        /**
+         * @brief Replaces the manager state by the one of a checkpoint file.
+         *
+         * All BDD_IDs handed out by the checkpointed manager are valid again.
+         * Throws std::runtime_error if the file is not a complete checkpoint
+         * of this build; the manager is then left unchanged.
+         */
+        void restore(const std::string &filepath);
+
     private:
         struct Node {
             BDD_ID id, topVar, low, high;
         };
 
-        BDD_ID currentID;
         BDD_ID trueID, falseID;
 
         std::map<std::string, BDD_ID> labelToID;
         std::map<BDD_ID, std::string> idToLabel;
-        std::map<BDD_ID, Node> uniqueTable;
+        std::vector<Node> uniqueTable; ///< Indexed by BDD_ID
+        std::vector<BDD_ID> freeIDs;   ///< Slots freed by collectGarbage, reused by addNode
+        size_t peakLiveNodes = 2;
+        CacheStatistics cacheStats;
+        std::vector<uint32_t> visitStamp; ///< Per node, the analyzeRoots call that visited it last
+        std::vector<uint32_t> visitSlot;  ///< Per visited node, its post-order position in that call
+        uint32_t visitGeneration = 0;
         std::unordered_map<std::tuple<BDD_ID, BDD_ID, BDD_ID>, BDD_ID, TupleHash> computedTable;
         std::unordered_map<std::tuple<BDD_ID, BDD_ID, BDD_ID>, BDD_ID, TupleHash> uniqueHashTable;
-        std::set<BDD_ID> variableIDs;
 
         BDD_ID addNode(BDD_ID topVar, BDD_ID high, BDD_ID low);
     };
@@ -5,13 +5,29 @@
 #ifndef VDSPROJECT_MANAGERINTERFACE_H
 #define VDSPROJECT_MANAGERINTERFACE_H
 
+#include <cstdint>
 #include <string>
 #include <set>
+#include <vector>
 
 namespace ClassProject {
 
     typedef size_t BDD_ID;
 
+    /**
+     * @brief Sizes and supports of several BDDs, as computed by ManagerInterface::analyzeRoots.
+     */
+    struct RootAnalysis {
+        std::vector<BDD_ID> variables;   ///< All variables in order; bit i of a support stands for variables[i]
+        std::vector<size_t> nodeCounts;  ///< Per root, its nodes including the terminals it reaches
+        size_t sharedNodeCount = 0;      ///< Nodes reachable from at least one root
+        std::vector<std::vector<uint64_t>> supports; ///< Per root, a bitset of the variables it depends on
+
+        bool inSupport(size_t root, size_t var) const {
+            return (supports[root][var / 64] >> (var % 64)) & 1;
+        }
+    };
+
     class ManagerInterface {
     public:
         virtual BDD_ID createVar(const std::string &label) = 0;
@@ -58,7 +74,15 @@ namespace ClassProject {
 
         virtual size_t uniqueTableSize() = 0;
 
+        virtual RootAnalysis analyzeRoots(const std::vector<BDD_ID> &roots) = 0;
+
         virtual void visualizeBDD(std::string filepath, BDD_ID &root) = 0;
+
+        virtual size_t collectGarbage(const std::vector<BDD_ID> &roots) = 0;
+
+        virtual size_t liveNodeCount() = 0;
+
+        virtual size_t peakLiveNodeCount() = 0;
     };
 }
 
@@ -0,0 +1,39 @@
+//
+// Read-only memory mapping of an input file
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * \class MappedFile
+ *
+ * \brief Maps a whole file read-only into memory for the lifetime of the object.
+ *
+ *  Parsers work directly on [begin(), end()) without copying the file into
+ *   a stream buffer. An empty file yields an empty range. Readers that jump
+ *   around in the file, like ClassProject::BDDStore, pass sequential = false
+ *   so the kernel does not read ahead for a front-to-back scan.
+ *
+ */
+class MappedFile {
+
+public:
+
+    explicit MappedFile(const std::string &path, bool sequential = true);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *begin() const { return data; }
+    const char *end() const { return data + length; }
+    size_t size() const { return length; }
+
+private:
+
+    const char *data = nullptr;
+    size_t length = 0;
+};
@@ -0,0 +1,319 @@
+//
+// Reader for And-Inverter Graphs in the AIGER format
+//
+
+#include "AigerReader.hpp"
+#include "../MappedFile.hpp"
+
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    /* Position in the mapped file with the line number for error messages */
+    class AigerCursor {
+    public:
+        AigerCursor(const char *begin, const char *end, const std::string &file)
+                : pos(begin), end(end), file(file) {}
+
+        [[noreturn]] void Fail(const std::string &detail) const {
+            throw std::runtime_error(file + ": line " + std::to_string(line) + ": " + detail);
+        }
+
+        bool AtEnd() const { return pos == end; }
+
+        char Peek() const { return pos == end ? '\0' : *pos; }
+
+        void SkipSpaces() {
+            while (pos != end && *pos == ' ') {
+                ++pos;
+            }
+        }
+
+        bool AtEndOfLine() {
+            SkipSpaces();
+            return pos == end || *pos == '\n';
+        }
+
+        uint32_t Unsigned() {
+            SkipSpaces();
+            if (pos == end || *pos < '0' || *pos > '9') {
+                Fail("expected an unsigned number");
+            }
+            uint64_t value = 0;
+            while (pos != end && *pos >= '0' && *pos <= '9') {
+                value = value * 10 + static_cast<uint64_t>(*pos++ - '0');
+                if (value > UINT32_MAX) {
+                    Fail("number out of range");
+                }
+            }
+            return static_cast<uint32_t>(value);
+        }
+
+        std::string_view Word() {
+            SkipSpaces();
+            const char *first = pos;
+            while (pos != end && *pos != ' ' && *pos != '\n') {
+                ++pos;
+            }
+            return {first, static_cast<size_t>(pos - first)};
+        }
+
+        /* Rest of the line, used for names, which may contain blanks */
+        std::string_view RestOfLine() {
+            const char *first = pos;
+            while (pos != end && *pos != '\n') {
+                ++pos;
+            }
+            return {first, static_cast<size_t>(pos - first)};
+        }
+
+        void EndOfLine() {
+            if (!AtEndOfLine()) {
+                Fail("expected end of line");
+            }
+            if (pos != end) {
+                ++pos;
+            }
+            ++line;
+        }
+
+        /* Unsigned LEB128 number of the binary AND gate section */
+        uint32_t Varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                if (pos == end) {
+                    Fail("unexpected end of the binary AND gates");
+                }
+                auto byte = static_cast<unsigned char>(*pos++);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    if (value > UINT32_MAX) {
+                        break;
+                    }
+                    return static_cast<uint32_t>(value);
+                }
+            }
+            Fail("malformed binary AND gate delta");
+        }
+
+    private:
+        const char *pos;
+        const char *end;
+        const std::string &file;
+        size_t line = 1;
+    };
+
+    struct and_gate_t {
+        uint32_t lhs;
+        uint32_t rhs0;
+        uint32_t rhs1;
+    };
+}
+
+Circuit AigerReader::Read(const std::string &aiger_file) {
+    MappedFile file(aiger_file);
+    AigerCursor cursor(file.begin(), file.end(), aiger_file);
+
+    std::string_view format = cursor.Word();
+    bool binary = format == "aig";
+    if (!binary && format != "aag") {
+        cursor.Fail("expected 'aag' or 'aig' header");
+    }
+    uint32_t max_var = cursor.Unsigned();
+    uint32_t input_count = cursor.Unsigned();
+    uint32_t latch_count = cursor.Unsigned();
+    uint32_t output_count = cursor.Unsigned();
+    uint32_t and_count = cursor.Unsigned();
+    while (!cursor.AtEndOfLine()) {
+        if (cursor.Unsigned() != 0) {
+            cursor.Fail("bad state, constraint, justice and fairness properties are not supported");
+        }
+    }
+    cursor.EndOfLine();
+    if (static_cast<uint64_t>(input_count) + latch_count + and_count > max_var) {
+        cursor.Fail("header declares more variables than M");
+    }
+
+    auto check_literal = [&](uint32_t literal) {
+        if (literal / 2 > max_var) {
+            cursor.Fail("literal " + std::to_string(literal) + " exceeds the maximum variable");
+        }
+        return literal;
+    };
+
+    /* Variable index of each input and latch, and the next state of each latch */
+    std::vector<uint32_t> input_vars(input_count), latch_vars(latch_count), latch_next(latch_count);
+    std::vector<uint32_t> output_literals(output_count);
+    std::vector<and_gate_t> and_gates(and_count);
+
+    for (uint32_t i = 0; i < input_count; ++i) {
+        if (binary) {
+            input_vars[i] = i + 1;
+        } else {
+            uint32_t literal = check_literal(cursor.Unsigned());
+            if (literal < 2 || literal % 2) {
+                cursor.Fail("input literal must be a positive, even literal");
+            }
+            input_vars[i] = literal / 2;
+            cursor.EndOfLine();
+        }
+    }
+    for (uint32_t i = 0; i < latch_count; ++i) {
+        if (binary) {
+            latch_vars[i] = input_count + i + 1;
+        } else {
+            uint32_t literal = check_literal(cursor.Unsigned());
+            if (literal < 2 || literal % 2) {
+                cursor.Fail("latch literal must be a positive, even literal");
+            }
+            latch_vars[i] = literal / 2;
+        }
+        latch_next[i] = check_literal(cursor.Unsigned());
+        if (!cursor.AtEndOfLine()) {
+            cursor.Unsigned(); /* initial value */
+        }
+        cursor.EndOfLine();
+    }
+    for (uint32_t i = 0; i < output_count; ++i) {
+        output_literals[i] = check_literal(cursor.Unsigned());
+        cursor.EndOfLine();
+    }
+    for (uint32_t i = 0; i < and_count; ++i) {
+        and_gate_t &gate = and_gates[i];
+        if (binary) {
+            /* AND gates are numbered after the latches; the fanins are
+               delta encoded, lhs > rhs0 >= rhs1 */
+            gate.lhs = 2 * (input_count + latch_count + i + 1);
+            uint32_t delta0 = cursor.Varint();
+            uint32_t delta1 = cursor.Varint();
+            if (delta0 == 0 || delta0 > gate.lhs || delta1 > gate.lhs - delta0) {
+                cursor.Fail("invalid delta of binary AND gate " + std::to_string(i));
+            }
+            gate.rhs0 = gate.lhs - delta0;
+            gate.rhs1 = gate.rhs0 - delta1;
+        } else {
+            gate.lhs = check_literal(cursor.Unsigned());
+            gate.rhs0 = check_literal(cursor.Unsigned());
+            gate.rhs1 = check_literal(cursor.Unsigned());
+            if (gate.lhs < 2 || gate.lhs % 2) {
+                cursor.Fail("AND gate literal must be a positive, even literal");
+            }
+            cursor.EndOfLine();
+        }
+    }
+
+    /* Optional symbol table, ended by the comment section */
+    std::vector<std::string> input_names(input_count), latch_names(latch_count), output_names(output_count);
+    while (!cursor.AtEnd() && cursor.Peek() != 'c') {
+        std::string_view kind = cursor.Word();
+        std::vector<std::string> *names = nullptr;
+        if (kind.size() > 1 && kind[0] == 'i') {
+            names = &input_names;
+        } else if (kind.size() > 1 && kind[0] == 'l') {
+            names = &latch_names;
+        } else if (kind.size() > 1 && kind[0] == 'o') {
+            names = &output_names;
+        } else {
+            cursor.Fail("invalid symbol table entry");
+        }
+        size_t index = 0;
+        for (char digit : kind.substr(1)) {
+            if (digit < '0' || digit > '9') {
+                cursor.Fail("invalid symbol table entry");
+            }
+            index = index * 10 + static_cast<size_t>(digit - '0');
+        }
+        if (index >= names->size()) {
+            cursor.Fail("symbol table entry for a missing " + std::string(kind.substr(0, 1)));
+        }
+        cursor.SkipSpaces();
+        (*names)[index] = std::string(cursor.RestOfLine());
+        cursor.EndOfLine();
+    }
+
+    auto name_or = [](const std::string &name, char prefix, size_t index) {
+        return name.empty() ? prefix + std::to_string(index) : name;
+    };
+
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+
+    /* The builder keeps the first definition of a label, so a symbol that
+       matches another label would silently export the wrong function;
+       every label, named or generated, may therefore be claimed only once */
+    std::vector<bool> claimed;
+    auto claim = [&](const std::string &label) {
+        symbol_t symbol = symbols.Intern(label);
+        if (symbol >= claimed.size()) {
+            claimed.resize(static_cast<size_t>(symbol) + 1, false);
+        }
+        if (claimed[symbol]) {
+            throw std::runtime_error(aiger_file + ": label " + label + " is used twice");
+        }
+        claimed[symbol] = true;
+        return symbol;
+    };
+
+    /* The label of every variable, then the gates reading them */
+    std::vector<symbol_t> var_label(static_cast<size_t>(max_var) + 1);
+    std::vector<bool> defined(var_label.size(), false);
+    auto define = [&](uint32_t var, const std::string &label) {
+        if (var == 0 || defined[var]) {
+            throw std::runtime_error(aiger_file + ": variable " + std::to_string(var) + " is defined twice");
+        }
+        defined[var] = true;
+        var_label[var] = claim(label);
+    };
+    var_label[0] = claim("$0");
+    defined[0] = true;
+    builder.AddGate(var_label[0], gate_type_t::Const0, {});
+    for (uint32_t i = 0; i < input_count; ++i) {
+        define(input_vars[i], name_or(input_names[i], 'i', i));
+        builder.AddInput(var_label[input_vars[i]]);
+    }
+    for (uint32_t i = 0; i < latch_count; ++i) {
+        define(latch_vars[i], name_or(latch_names[i], 'l', i));
+    }
+    for (const auto &gate : and_gates) {
+        define(gate.lhs / 2, "$" + std::to_string(gate.lhs / 2));
+    }
+
+    /* The negation of a variable is created once, on its first use */
+    std::vector<bool> negated(var_label.size(), false);
+    std::vector<symbol_t> negation(var_label.size());
+    auto literal_label = [&](uint32_t literal) {
+        uint32_t var = literal / 2;
+        if (!defined[var]) {
+            throw std::runtime_error(aiger_file + ": literal " + std::to_string(literal) + " is never defined");
+        }
+        if (literal % 2 == 0) {
+            return var_label[var];
+        }
+        if (!negated[var]) {
+            negated[var] = true;
+            negation[var] = claim("!" + std::string(symbols.Name(var_label[var])));
+            builder.AddGate(negation[var], gate_type_t::Not, {var_label[var]});
+        }
+        return negation[var];
+    };
+
+    for (const auto &gate : and_gates) {
+        builder.AddGate(var_label[gate.lhs / 2], gate_type_t::And,
+                        {literal_label(gate.rhs0), literal_label(gate.rhs1)});
+    }
+    for (uint32_t i = 0; i < latch_count; ++i) {
+        std::string latch_name(symbols.Name(var_label[latch_vars[i]]));
+        symbol_t next = claim(latch_name + ".next");
+        builder.AddGate(next, gate_type_t::Buff, {literal_label(latch_next[i])});
+        builder.AddGate(var_label[latch_vars[i]], gate_type_t::Dff, {next});
+    }
+    for (uint32_t i = 0; i < output_count; ++i) {
+        symbol_t output = claim(name_or(output_names[i], 'o', i));
+        builder.AddGate(output, gate_type_t::Buff, {literal_label(output_literals[i])});
+        builder.AddOutput(output);
+    }
+
+    return builder.Build();
+}
@@ -0,0 +1,42 @@
+//
+// Reader for And-Inverter Graphs in the AIGER format
+//
+
+#pragma once
+
+#include "Circuit.hpp"
+
+#include <string>
+
+/**
+ * \class AigerReader
+ *
+ * \brief Reads ASCII (aag) and binary (aig) AIGER files into a Circuit.
+ *
+ *  Supports the combinational and latch sections of AIGER 1.0 and the
+ *   header of AIGER 1.9 as long as it declares no bad state, constraint,
+ *   justice or fairness properties. Latch initial values are ignored.
+ *
+ *  Inputs, latches and outputs take their names from the symbol table of the
+ *   file, or i<n>, l<n> and o<n> if they have none. Internal signals get names
+ *   that cannot clash with bench identifiers: AND gate v is "$v", the
+ *   negation of signal x is "!x" and the constant is "$0". Every output is a
+ *   BUFF of its literal named after the output; the next-state function of
+ *   latch x is a BUFF named "x.next". A symbol that matches any other label,
+ *   named or generated, is rejected rather than silently dropped.
+ *
+ */
+class AigerReader {
+
+public:
+
+    /**
+     * \brief Reads an AIGER file; the format is taken from the header
+     * \param aiger_file the path of the .aag or .aig file
+     * \return Circuit
+     *
+     *  Throws std::runtime_error if the file is malformed or two signals
+     *   share a label.
+     */
+    static Circuit Read(const std::string &aiger_file);
+};
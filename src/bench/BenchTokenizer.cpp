@@ -0,0 +1,259 @@
+//
+// Hand-written tokenizer for the ISCAS85/89/99 bench format
+//
+
+#include "BenchTokenizer.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace {
+    /* Below this size per thread, starting threads costs more than it saves */
+    const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    inline bool IsIdentifierChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
+
+    inline bool IsSingleInputGate(std::string_view keyword) {
+        return keyword == "NOT" || keyword == "BUFF" || keyword == "DFF";
+    }
+
+    inline bool IsMultipleInputGate(std::string_view keyword) {
+        return keyword == "AND" || keyword == "OR" || keyword == "NAND" || keyword == "NOR" || keyword == "XOR";
+    }
+
+    /* Start of the line after the one pos is in; lines end in "\n", "\r\n" or a lone "\r" as in the tokenizer */
+    const char *NextLineStart(const char *pos, const char *end) {
+        pos = std::find_if(pos, end, [](char c) { return c == '\n' || c == '\r'; });
+        if (pos != end && *pos++ == '\r' && pos != end && *pos == '\n') {
+            ++pos;
+        }
+        return pos;
+    }
+}
+
+BenchTokenizer::BenchTokenizer(const char *begin, const char *end, SymbolTable &symbols, size_t first_line)
+        : pos(begin), end(end), symbols(symbols), line(first_line) {}
+
+void BenchTokenizer::SkipBlanks() {
+    while (pos != end && (*pos == ' ' || *pos == '\t')) {
+        ++pos;
+    }
+    /* A comment runs up to, but not including, the end of the line */
+    if (pos != end && *pos == '#') {
+        while (pos != end && *pos != '\n' && *pos != '\r') {
+            ++pos;
+        }
+    }
+}
+
+bool BenchTokenizer::SkipEmptyLine() {
+    if (pos == end) {
+        return false;
+    }
+    if (*pos == '\r') {
+        ++pos;
+        if (pos != end && *pos == '\n') ++pos;
+    } else if (*pos == '\n') {
+        ++pos;
+    } else {
+        return false;
+    }
+    ++line;
+    return true;
+}
+
+std::string_view BenchTokenizer::Identifier() {
+    const char *first = pos;
+    while (pos != end && IsIdentifierChar(*pos)) {
+        ++pos;
+    }
+    if (pos == first) {
+        Fail("a label");
+    }
+    return {first, static_cast<size_t>(pos - first)};
+}
+
+void BenchTokenizer::Expect(char c) {
+    SkipBlanks();
+    if (pos == end || *pos != c) {
+        const char expected[] = {'\'', c, '\'', '\0'};
+        Fail(expected);
+    }
+    ++pos;
+    SkipBlanks();
+}
+
+void BenchTokenizer::ExpectEndOfStatement() {
+    SkipBlanks();
+    if (pos != end && !SkipEmptyLine()) {
+        Fail("end of line");
+    }
+}
+
+void BenchTokenizer::Fail(const char *expected) {
+    std::string found = pos == end ? "end of file" : "'" + std::string(1, *pos) + "'";
+    throw bench_syntax_error(line, std::string("expected ") + expected + ", found " + found);
+}
+
+bool BenchTokenizer::Next(bench_statement_t &statement) {
+    do {
+        SkipBlanks();
+    } while (SkipEmptyLine());
+    if (pos == end) {
+        return false;
+    }
+
+    statement.line = line;
+    statement.inputs.clear();
+
+    std::string_view first = Identifier();
+    SkipBlanks();
+
+    if (pos != end && *pos == '(' && (first == "INPUT" || first == "OUTPUT")) {
+        statement.gate_type = first;
+        Expect('(');
+        statement.label = symbols.Intern(Identifier());
+        Expect(')');
+        ExpectEndOfStatement();
+        return true;
+    }
+
+    statement.label = symbols.Intern(first);
+    Expect('=');
+
+    const char *keyword_begin = pos;
+    std::string_view keyword = Identifier();
+    bool single_input = IsSingleInputGate(keyword);
+    if (!single_input && !IsMultipleInputGate(keyword)) {
+        pos = keyword_begin;
+        Fail("a gate type");
+    }
+    statement.gate_type = keyword;
+
+    Expect('(');
+    statement.inputs.push_back(symbols.Intern(Identifier()));
+    SkipBlanks();
+    while (pos != end && *pos == ',') {
+        Expect(',');
+        statement.inputs.push_back(symbols.Intern(Identifier()));
+        SkipBlanks();
+    }
+    Expect(')');
+
+    if (single_input && statement.inputs.size() != 1) {
+        throw bench_syntax_error(statement.line, std::string(keyword) + " takes exactly one input");
+    }
+    if (!single_input && statement.inputs.size() < 2) {
+        throw bench_syntax_error(statement.line, std::string(keyword) + " takes at least two inputs");
+    }
+
+    ExpectEndOfStatement();
+    return true;
+}
+
+namespace {
+    struct chunk_result_t {
+        const char *begin;
+        const char *end;
+        SymbolTable symbols;
+        std::vector<bench_statement_t> statements;
+        size_t line_count = 0;
+        std::exception_ptr error;
+    };
+
+    void TokenizeChunk(chunk_result_t &chunk) {
+        try {
+            BenchTokenizer tokenizer(chunk.begin, chunk.end, chunk.symbols);
+            bench_statement_t statement;
+            while (tokenizer.Next(statement)) {
+                chunk.statements.push_back(std::move(statement));
+            }
+            chunk.line_count = tokenizer.Line() - 1;
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+    }
+}
+
+std::vector<bench_statement_t> TokenizeBench(const char *begin, const char *end, SymbolTable &symbols,
+                                             unsigned threads) {
+    size_t size = static_cast<size_t>(end - begin);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, size / MIN_CHUNK_SIZE)));
+
+    std::vector<bench_statement_t> statements;
+    if (threads == 1) {
+        BenchTokenizer tokenizer(begin, end, symbols);
+        bench_statement_t statement;
+        while (tokenizer.Next(statement)) {
+            statements.push_back(std::move(statement));
+        }
+        return statements;
+    }
+
+    /* Chunk boundaries are moved forward to the start of the next line */
+    std::vector<chunk_result_t> chunks(threads);
+    const char *chunk_begin = begin;
+    for (unsigned i = 0; i < threads; ++i) {
+        const char *chunk_end = i + 1 == threads ? end : begin + size / threads * (i + 1);
+        if (chunk_end < chunk_begin) {
+            chunk_end = chunk_begin;
+        }
+        if (chunk_end != end) {
+            /* A boundary between the two characters of "\r\n" moves past the "\n" */
+            chunk_end = NextLineStart(chunk_end > begin && chunk_end[-1] == '\r' ? chunk_end - 1 : chunk_end, end);
+        }
+        chunks[i].begin = chunk_begin;
+        chunks[i].end = chunk_end;
+        chunk_begin = chunk_end;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(TokenizeChunk, std::ref(chunks[i]));
+    }
+    TokenizeChunk(chunks[0]);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    /* Merge in text order: report the first error with its line in the whole
+       text, and translate the chunk-local symbols into symbols of the caller */
+    size_t total = 0;
+    for (const auto &chunk : chunks) {
+        total += chunk.statements.size();
+    }
+    statements.reserve(total);
+
+    size_t line_offset = 0;
+    std::vector<symbol_t> to_global;
+    for (auto &chunk : chunks) {
+        if (chunk.error) {
+            try {
+                std::rethrow_exception(chunk.error);
+            } catch (const bench_syntax_error &error) {
+                throw bench_syntax_error(error.line + line_offset, error.detail);
+            }
+        }
+
+        to_global.resize(chunk.symbols.Size());
+        for (symbol_t local = 0; local < chunk.symbols.Size(); ++local) {
+            to_global[local] = symbols.Intern(chunk.symbols.Name(local));
+        }
+        for (auto &statement : chunk.statements) {
+            statement.label = to_global[statement.label];
+            for (auto &input : statement.inputs) {
+                input = to_global[input];
+            }
+            statement.line += line_offset;
+            statements.push_back(std::move(statement));
+        }
+        line_offset += chunk.line_count;
+    }
+    return statements;
+}
@@ -0,0 +1,114 @@
+//
+// Hand-written tokenizer for the ISCAS85/89/99 bench format
+//
+
+#pragma once
+
+#include "SymbolTable.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \struct bench_statement_t
+ * \brief One INPUT, OUTPUT or gate statement of a bench file.
+ *
+ */
+typedef struct bench_statement_t {
+    symbol_t label;               ///< Declared signal, or the signal defined by the gate
+    std::string_view gate_type;   ///< INPUT, OUTPUT or the gate keyword (ex. AND, NOT, DFF)
+    std::vector<symbol_t> inputs; ///< Fanin signals of a gate, empty for INPUT and OUTPUT
+    size_t line;                  ///< Line of the statement in the file
+} bench_statement_t;
+
+/**
+ * \class bench_syntax_error
+ * \brief Thrown on a syntax error, what() reads "line <line>: <detail>".
+ *
+ */
+class bench_syntax_error : public std::runtime_error {
+public:
+    bench_syntax_error(size_t line, const std::string &detail)
+            : std::runtime_error("line " + std::to_string(line) + ": " + detail), line(line), detail(detail) {}
+
+    size_t line;        ///< Line of the error
+    std::string detail; ///< Description of the error without the line
+};
+
+/**
+ * \class BenchTokenizer
+ *
+ * \brief Splits a bench file held in memory into statements.
+ *
+ *  Accepts the grammar of bench_grammar.hpp: INPUT(x) and OUTPUT(x)
+ *   declarations, single input gates (NOT, BUFF, DFF) with exactly one
+ *   operand and multiple input gates (AND, OR, NAND, NOR, XOR) with at least
+ *   two, one statement per line, blanks and '#' comments in between.
+ *   Empty lines and a missing newline at the end of the file are accepted.
+ *   Labels are handed out as symbols of the given SymbolTable.
+ *
+ */
+class BenchTokenizer {
+
+public:
+
+    /**
+     * \param begin first character of the text
+     * \param end one past the last character of the text
+     * \param symbols table the labels are interned into
+     * \param first_line line number of the first character, used in error messages
+     */
+    BenchTokenizer(const char *begin, const char *end, SymbolTable &symbols, size_t first_line = 1);
+
+    /**
+     * \brief Reads the next statement
+     * \param statement receives the statement
+     * \return false when the end of the text is reached
+     *
+     *  Throws bench_syntax_error on a syntax error.
+     */
+    bool Next(bench_statement_t &statement);
+
+    /**
+     * \brief Line number the tokenizer is at
+     * \return size_t
+     *
+     *  After Next returned false, one past the last line of the text.
+     */
+    size_t Line() const { return line; }
+
+private:
+
+    const char *pos;
+    const char *end;
+    SymbolTable &symbols;
+    size_t line;
+
+    void SkipBlanks();
+    bool SkipEmptyLine();
+    std::string_view Identifier();
+    void Expect(char c);
+    void ExpectEndOfStatement();
+    [[noreturn]] void Fail(const char *expected);
+};
+
+/**
+ * \brief Tokenizes a whole bench text, using several threads for large texts
+ * \param begin first character of the text
+ * \param end one past the last character of the text
+ * \param symbols table the labels are interned into
+ * \param threads number of threads, 0 uses one per hardware thread
+ * \return the statements in the order of the text
+ *
+ *  The text is split at line boundaries, after "\n", "\r\n" or a lone "\r",
+ *   into one chunk per thread. Each
+ *   thread tokenizes its chunk into its own statement buffer and symbol
+ *   table, since a chunk may refer to labels defined in a later one. A final
+ *   pass interns the chunk-local labels into symbols, in text order, and
+ *   renumbers the statements. Texts below a few megabytes are tokenized on
+ *   the calling thread.
+ */
+std::vector<bench_statement_t> TokenizeBench(const char *begin, const char *end, SymbolTable &symbols,
+                                             unsigned threads = 0);
@@ -12,6 +12,7 @@
  * Taken from: Minisat-1.14 Global.h library
  */
 
+#include <chrono>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
@@ -61,4 +62,27 @@ long long memUsing();
 
 void process_mem_usage(double& vm_usage, double& resident_set);
 
+// wall clock and cpu (user + system) seconds spent in one stage of a run
+struct stage_time_t {
+	double wall = 0;
+	double cpu = 0;
+};
+
+// measures the stage from its construction to Elapsed()
+class StageTimer {
+public:
+	StageTimer() : wall_start(std::chrono::steady_clock::now()), cpu_start(totalTime()) {}
+
+	stage_time_t Elapsed() const {
+		stage_time_t time;
+		time.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+		time.cpu = totalTime() - cpu_start;
+		return time;
+	}
+
+private:
+	std::chrono::steady_clock::time_point wall_start;
+	double cpu_start;
+};
+
 #endif /* BENCHMARKLIB_H_ */
@@ -0,0 +1,208 @@
+//
+// Reader for netlists in the Berkeley Logic Interchange Format
+//
+
+#include "BlifReader.hpp"
+#include "../MappedFile.hpp"
+
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    /* Splits the file into logical lines (comments removed, continuations
+       joined) and each line into whitespace separated words */
+    class BlifLines {
+    public:
+        BlifLines(const char *begin, const char *end) : pos(begin), end(end) {}
+
+        bool Next(std::vector<std::string> &words) {
+            words.clear();
+            std::string word;
+            bool continued = false;
+            while (pos != end) {
+                char c = *pos++;
+                if (c == '#') {
+                    while (pos != end && *pos != '\n') {
+                        ++pos;
+                    }
+                } else if (c == '\\' && (pos == end || *pos == '\n' || *pos == '\r')) {
+                    continued = true;
+                } else if (c == '\n') {
+                    ++line;
+                    if (!word.empty()) {
+                        words.push_back(std::move(word));
+                        word.clear();
+                    }
+                    if (!continued && !words.empty()) {
+                        return true;
+                    }
+                    continued = false;
+                } else if (c == ' ' || c == '\t' || c == '\r') {
+                    if (!word.empty()) {
+                        words.push_back(std::move(word));
+                        word.clear();
+                    }
+                } else {
+                    word += c;
+                }
+            }
+            if (!word.empty()) {
+                words.push_back(std::move(word));
+            }
+            return !words.empty();
+        }
+
+        /* Line of the last character read, for error messages */
+        size_t Line() const { return line; }
+
+    private:
+        const char *pos;
+        const char *end;
+        size_t line = 1;
+    };
+
+    /* The .names command being read, completed by its cube lines */
+    struct names_t {
+        std::vector<symbol_t> inputs;
+        symbol_t output = 0;
+        std::vector<std::string> cubes;
+        char output_value = 0; ///< '1' for an on-set cover, '0' for an off-set cover
+        bool open = false;
+    };
+}
+
+Circuit BlifReader::Read(const std::string &blif_file) {
+    MappedFile file(blif_file);
+    BlifLines lines(file.begin(), file.end());
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+
+    auto fail = [&](const std::string &detail) {
+        throw std::runtime_error(blif_file + ": line " + std::to_string(lines.Line()) + ": " + detail);
+    };
+
+    auto negation = [&](symbol_t signal) {
+        symbol_t label = symbols.Intern("!" + std::string(symbols.Name(signal)));
+        builder.AddGate(label, gate_type_t::Not, {signal});
+        return label;
+    };
+
+    names_t names;
+    auto finish_names = [&]() {
+        if (!names.open) {
+            return;
+        }
+        names.open = false;
+        if (names.cubes.empty()) {
+            builder.AddGate(names.output, gate_type_t::Const0, {});
+            return;
+        }
+        bool on_set = names.output_value == '1';
+
+        /* The literals of every cube; a cube without literals covers everything */
+        std::vector<symbol_t> cube_labels;
+        std::vector<std::vector<symbol_t>> cube_literals;
+        for (const auto &cube : names.cubes) {
+            std::vector<symbol_t> literals;
+            for (size_t i = 0; i < cube.size(); ++i) {
+                if (cube[i] == '1') {
+                    literals.push_back(names.inputs[i]);
+                } else if (cube[i] == '0') {
+                    literals.push_back(negation(names.inputs[i]));
+                }
+            }
+            if (literals.empty()) {
+                builder.AddGate(names.output, on_set ? gate_type_t::Const1 : gate_type_t::Const0, {});
+                return;
+            }
+            cube_literals.push_back(std::move(literals));
+        }
+
+        if (cube_literals.size() == 1) {
+            const auto &literals = cube_literals.front();
+            if (literals.size() == 1) {
+                builder.AddGate(names.output, on_set ? gate_type_t::Buff : gate_type_t::Not, literals);
+            } else {
+                builder.AddGate(names.output, on_set ? gate_type_t::And : gate_type_t::Nand, literals);
+            }
+            return;
+        }
+        std::string output_name(symbols.Name(names.output));
+        for (size_t k = 0; k < cube_literals.size(); ++k) {
+            if (cube_literals[k].size() == 1) {
+                cube_labels.push_back(cube_literals[k].front());
+            } else {
+                symbol_t cube = symbols.Intern(output_name + "$" + std::to_string(k));
+                builder.AddGate(cube, gate_type_t::And, cube_literals[k]);
+                cube_labels.push_back(cube);
+            }
+        }
+        builder.AddGate(names.output, on_set ? gate_type_t::Or : gate_type_t::Nor, cube_labels);
+    };
+
+    std::vector<std::string> words;
+    bool model_seen = false;
+    while (lines.Next(words)) {
+        const std::string &command = words[0];
+        if (command[0] != '.') {
+            /* A cube line of the current .names: "<inputs> <value>", or "<value>" without inputs */
+            if (!names.open) {
+                fail("unexpected '" + command + "' outside of a .names cover");
+            }
+            std::string cube = names.inputs.empty() ? "" : words[0];
+            const std::string &value = words.back();
+            if (words.size() != (names.inputs.empty() ? 1u : 2u) || cube.size() != names.inputs.size() ||
+                cube.find_first_not_of("01-") != std::string::npos || (value != "0" && value != "1")) {
+                fail("malformed cube for " + std::string(symbols.Name(names.output)));
+            }
+            if (names.output_value != 0 && names.output_value != value[0]) {
+                fail("cover of " + std::string(symbols.Name(names.output)) + " mixes on-set and off-set cubes");
+            }
+            names.output_value = value[0];
+            names.cubes.push_back(std::move(cube));
+            continue;
+        }
+
+        finish_names();
+        if (command == ".model") {
+            if (model_seen) {
+                fail("only one .model is supported");
+            }
+            model_seen = true;
+        } else if (command == ".inputs") {
+            for (size_t i = 1; i < words.size(); ++i) {
+                builder.AddInput(symbols.Intern(words[i]));
+            }
+        } else if (command == ".outputs") {
+            for (size_t i = 1; i < words.size(); ++i) {
+                builder.AddOutput(symbols.Intern(words[i]));
+            }
+        } else if (command == ".names") {
+            if (words.size() < 2) {
+                fail(".names needs an output");
+            }
+            names = names_t();
+            names.open = true;
+            for (size_t i = 1; i + 1 < words.size(); ++i) {
+                names.inputs.push_back(symbols.Intern(words[i]));
+            }
+            names.output = symbols.Intern(words.back());
+        } else if (command == ".latch") {
+            if (words.size() < 3) {
+                fail(".latch needs an input and an output");
+            }
+            builder.AddGate(symbols.Intern(words[2]), gate_type_t::Dff, {symbols.Intern(words[1])});
+        } else if (command == ".end") {
+            break;
+        } else if (command == ".subckt" || command == ".gate" || command == ".mlatch" || command == ".search" ||
+                   command == ".exdc") {
+            fail(command + " is not supported");
+        }
+        /* Other commands (timing, clocks, attributes) do not change the logic */
+    }
+    finish_names();
+
+    return builder.Build();
+}
@@ -0,0 +1,40 @@
+//
+// Reader for netlists in the Berkeley Logic Interchange Format
+//
+
+#pragma once
+
+#include "Circuit.hpp"
+
+#include <string>
+
+/**
+ * \class BlifReader
+ *
+ * \brief Reads the first model of a BLIF file into a Circuit.
+ *
+ *  Supports .inputs, .outputs, .names and .latch; a latch becomes a flip flop
+ *   and its type, clock and initial value are ignored. Hierarchical (.subckt)
+ *   and library-mapped (.gate, .mlatch) netlists are rejected.
+ *
+ *  A .names cover becomes the OR of one AND per cube, or their NOR if the
+ *   cover lists the off-set. Single-cube covers map onto one AND or NAND and
+ *   single-literal cubes need no AND at all. Internal signals get names that
+ *   cannot clash with bench identifiers: the negation of signal x is "!x"
+ *   and cube k of the cover of x is "x$k".
+ *
+ */
+class BlifReader {
+
+public:
+
+    /**
+     * \brief Reads a BLIF file
+     * \param blif_file the path of the .blif file
+     * \return Circuit
+     *
+     *  Throws std::runtime_error if the file is malformed or uses an
+     *   unsupported construct.
+     */
+    static Circuit Read(const std::string &blif_file);
+};
@@ -0,0 +1,76 @@
+//
+// Blocking queue with a fixed capacity, connecting a producer and a consumer thread
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * \class BoundedQueue
+ *
+ * \brief FIFO queue whose Push blocks while the queue is full.
+ *
+ *  The capacity bounds the memory held between a producer running ahead and
+ *   a slower consumer. Close ends the transfer from either side: Pop returns
+ *   false once the queue is closed and drained, Push drops its item once the
+ *   queue is closed.
+ *
+ */
+template<typename T>
+class BoundedQueue {
+
+public:
+
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    /**
+     * \brief Appends an item, waiting for room if the queue is full
+     * \return false if the queue was closed and the item dropped
+     */
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * \brief Removes the oldest item, waiting for one if the queue is empty
+     * \return false if the queue is closed and empty
+     */
+    bool Pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+
+    const size_t capacity;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    std::deque<T> items;
+    bool closed = false;
+};
@@ -0,0 +1,202 @@
+//
+// Compact circuit representation in compressed sparse row form
+//
+
+#include "Circuit.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    const char *const GATE_TYPE_NAMES[] = {"INPUT", "OUTPUT", "DFF", "BUFF", "NOT", "AND", "OR", "NAND", "NOR", "XOR",
+                                           "CONST0", "CONST1"};
+
+    const gate_t UNNUMBERED = UINT32_MAX;
+
+    template<typename T>
+    size_t VectorBytes(const std::vector<T> &vector) {
+        return vector.capacity() * sizeof(T);
+    }
+}
+
+const char *GateTypeName(gate_type_t type) {
+    return GATE_TYPE_NAMES[static_cast<size_t>(type)];
+}
+
+bool ParseGateType(std::string_view name, gate_type_t &type) {
+    for (size_t i = 0; i < sizeof(GATE_TYPE_NAMES) / sizeof(GATE_TYPE_NAMES[0]); ++i) {
+        if (name == GATE_TYPE_NAMES[i]) {
+            type = static_cast<gate_type_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Circuit::MemoryUsage() const {
+    return VectorBytes(types) + VectorBytes(labels) + VectorBytes(fanin_offsets) + VectorBytes(fanin_index) +
+           VectorBytes(fanout_offsets) + VectorBytes(fanout_index) + VectorBytes(outputs);
+}
+
+uint32_t &CircuitBuilder::DefinitionOf(symbol_t label) {
+    if (definition_of.size() <= label) {
+        definition_of.resize(symbols.Size(), UNDEFINED);
+    }
+    return definition_of[label];
+}
+
+void CircuitBuilder::AddInput(symbol_t label) {
+    uint32_t &definition = DefinitionOf(label);
+    if (definition == UNDEFINED) {
+        definition = static_cast<uint32_t>(definitions.size());
+        auto inputs = static_cast<uint32_t>(definition_inputs.size());
+        definitions.push_back({gate_type_t::Input, inputs, inputs});
+    }
+}
+
+void CircuitBuilder::AddOutput(symbol_t label) {
+    output_labels.push_back(label);
+}
+
+void CircuitBuilder::AddGate(symbol_t label, gate_type_t type, const std::vector<symbol_t> &inputs) {
+    uint32_t &definition = DefinitionOf(label);
+    if (definition != UNDEFINED) {
+        return;
+    }
+    definition = static_cast<uint32_t>(definitions.size());
+    auto inputs_begin = static_cast<uint32_t>(definition_inputs.size());
+    definition_inputs.insert(definition_inputs.end(), inputs.begin(), inputs.end());
+    definitions.push_back({type, inputs_begin, static_cast<uint32_t>(definition_inputs.size())});
+    if (type == gate_type_t::Dff) {
+        ff_labels.push_back(label);
+    }
+}
+
+Circuit CircuitBuilder::Build() {
+    Circuit circuit;
+    definition_of.resize(symbols.Size(), UNDEFINED);
+
+    /* Roots are numbered first to last: the outputs, then the flip flops, each sorted by label */
+    auto by_label = [this](symbol_t a, symbol_t b) { return symbols.Name(a) < symbols.Name(b); };
+    std::sort(output_labels.begin(), output_labels.end(), by_label);
+    output_labels.erase(std::unique(output_labels.begin(), output_labels.end()), output_labels.end());
+    std::sort(ff_labels.begin(), ff_labels.end(), by_label);
+
+    /* Number the gates in depth first preorder. A label names the gate that
+       defines it; for a flip flop that is its current state, an INPUT. The
+       input labels of every numbered gate are kept to resolve the fanins. */
+    std::vector<gate_t> gate_of(symbols.Size(), UNNUMBERED);
+    std::vector<std::pair<const symbol_t *, const symbol_t *>> gate_inputs;
+    std::vector<symbol_t> stack;
+
+    auto number = [&](gate_type_t type, symbol_t label, const symbol_t *inputs_begin, const symbol_t *inputs_end) {
+        circuit.types.push_back(type);
+        circuit.labels.push_back(label);
+        gate_inputs.emplace_back(inputs_begin, inputs_end);
+        /* Pushed in reverse, so the first input is visited first */
+        for (auto input = inputs_end; input != inputs_begin;) {
+            stack.push_back(*--input);
+        }
+    };
+
+    auto number_reachable = [&]() {
+        while (!stack.empty()) {
+            symbol_t label = stack.back();
+            stack.pop_back();
+            if (gate_of[label] != UNNUMBERED) {
+                continue;
+            }
+            if (definition_of[label] == UNDEFINED) {
+                throw std::runtime_error("There is no mapping from label '" + std::string(symbols.Name(label)) +
+                                         "' to a node.");
+            }
+            const definition_t &definition = definitions[definition_of[label]];
+            gate_of[label] = static_cast<gate_t>(circuit.types.size());
+            if (definition.type == gate_type_t::Dff) {
+                number(gate_type_t::Input, label, nullptr, nullptr);
+            } else {
+                number(definition.type, label, definition_inputs.data() + definition.inputs_begin,
+                       definition_inputs.data() + definition.inputs_end);
+            }
+        }
+    };
+
+    for (const symbol_t &label : output_labels) {
+        circuit.outputs.push_back(static_cast<gate_t>(circuit.types.size()));
+        number(gate_type_t::Output, label, &label, &label + 1);
+        number_reachable();
+    }
+    for (symbol_t label : ff_labels) {
+        const definition_t &definition = definitions[definition_of[label]];
+        circuit.outputs.push_back(static_cast<gate_t>(circuit.types.size()));
+        number(gate_type_t::Dff, label, definition_inputs.data() + definition.inputs_begin,
+               definition_inputs.data() + definition.inputs_end);
+        number_reachable();
+    }
+
+    /* Fanins sorted and without duplicates */
+    size_t gate_count = circuit.types.size();
+    circuit.fanin_offsets.reserve(gate_count + 1);
+    circuit.fanin_offsets.push_back(0);
+    for (const auto &inputs : gate_inputs) {
+        auto first = circuit.fanin_index.size();
+        for (auto input = inputs.first; input != inputs.second; ++input) {
+            circuit.fanin_index.push_back(gate_of[*input]);
+        }
+        std::sort(circuit.fanin_index.begin() + first, circuit.fanin_index.end());
+        circuit.fanin_index.erase(std::unique(circuit.fanin_index.begin() + first, circuit.fanin_index.end()),
+                                  circuit.fanin_index.end());
+        circuit.fanin_offsets.push_back(static_cast<uint32_t>(circuit.fanin_index.size()));
+    }
+
+    /* Fanouts by counting; filling in gate order keeps every list sorted */
+    circuit.fanout_offsets.assign(gate_count + 1, 0);
+    for (gate_t fanin : circuit.fanin_index) {
+        circuit.fanout_offsets[fanin + 1]++;
+    }
+    for (size_t gate = 0; gate < gate_count; ++gate) {
+        circuit.fanout_offsets[gate + 1] += circuit.fanout_offsets[gate];
+    }
+    circuit.fanout_index.resize(circuit.fanin_index.size());
+    std::vector<uint32_t> next_fanout(circuit.fanout_offsets.begin(), circuit.fanout_offsets.end() - 1);
+    for (gate_t gate = 0; gate < gate_count; ++gate) {
+        for (gate_t fanin : circuit.Fanins(gate)) {
+            circuit.fanout_index[next_fanout[fanin]++] = gate;
+        }
+    }
+
+    circuit.symbols = std::move(symbols);
+    *this = CircuitBuilder();
+    return circuit;
+}
+
+std::vector<gate_t> TopologicalOrder(const Circuit &circuit) {
+    /* Number of fanouts of each gate that are not sorted yet */
+    std::vector<uint32_t> remaining_fanouts(circuit.Size());
+    for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+        remaining_fanouts[gate] = static_cast<uint32_t>(circuit.Fanouts(gate).size());
+    }
+
+    /* Gates are sorted from the outputs, so order is filled from the back */
+    std::vector<gate_t> order(circuit.Size());
+    auto sorted = order.end();
+    std::vector<gate_t> stack(circuit.Outputs().rbegin(), circuit.Outputs().rend());
+    while (!stack.empty()) {
+        gate_t gate = stack.back();
+        stack.pop_back();
+        *--sorted = gate;
+
+        gate_range_t fanins = circuit.Fanins(gate);
+        for (auto fanin = fanins.end(); fanin != fanins.begin();) {
+            if (--remaining_fanouts[*--fanin] == 0) {
+                stack.push_back(*fanin);
+            }
+        }
+    }
+
+    if (sorted != order.begin()) {
+        throw std::runtime_error("The circuit must be cycle free!");
+    }
+    return order;
+}
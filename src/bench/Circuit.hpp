@@ -0,0 +1,188 @@
+//
+// Compact circuit representation in compressed sparse row form
+//
+
+#pragma once
+
+#include "SymbolTable.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Type of a gate of a circuit
+ *
+ *  Output and Dff are pseudo gates marking the roots of the circuit. An
+ *   Output reads the gate of the same label; a Dff reads the next-state
+ *   function of a flip flop, whose current state is an Input of the same label.
+ *   Const0 and Const1 have no fanins; they only come from AIGER and BLIF files.
+ */
+enum class gate_type_t : uint8_t {
+    Input, Output, Dff, Buff, Not, And, Or, Nand, Nor, Xor, Const0, Const1
+};
+
+typedef uint32_t gate_t; ///< Type definition for the index of a gate in a circuit
+
+/**
+ * \brief Returns the bench keyword of a gate type, e.g. "NAND"
+ */
+const char *GateTypeName(gate_type_t type);
+
+/**
+ * \brief Looks up the gate type of a bench keyword
+ * \param name the keyword, e.g. "NAND"
+ * \param type receives the gate type if the keyword is known
+ * \return true if the keyword is known
+ */
+bool ParseGateType(std::string_view name, gate_type_t &type);
+
+/**
+ * \struct gate_range_t
+ * \brief Contiguous range of gate indices, e.g. the fanins of a gate
+ */
+struct gate_range_t {
+    const gate_t *first;
+    const gate_t *last;
+
+    const gate_t *begin() const { return first; }
+    const gate_t *end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    gate_t operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * \class Circuit
+ *
+ * \brief Immutable gate graph with contiguous fanin and fanout arrays.
+ *
+ *  The fanins of gate g are fanin_index[fanin_offsets[g] .. fanin_offsets[g + 1]),
+ *   the fanouts are stored the same way. Both lists are sorted by gate index
+ *   and free of duplicates. Gates are numbered in depth first preorder from
+ *   the outputs, in the order the previous std::set based circuit assigned
+ *   its IDs, so that gates are combined in the same order as before.
+ *   Labels are interned in the symbol table owned by the circuit.
+ *
+ *  Circuits are created by a CircuitBuilder.
+ *
+ */
+class Circuit {
+
+public:
+
+    size_t Size() const { return types.size(); }
+
+    gate_type_t Type(gate_t gate) const { return types[gate]; }
+
+    symbol_t LabelSymbol(gate_t gate) const { return labels[gate]; }
+
+    std::string_view Label(gate_t gate) const { return symbols.Name(labels[gate]); }
+
+    gate_range_t Fanins(gate_t gate) const {
+        return {fanin_index.data() + fanin_offsets[gate], fanin_index.data() + fanin_offsets[gate + 1]};
+    }
+
+    gate_range_t Fanouts(gate_t gate) const {
+        return {fanout_index.data() + fanout_offsets[gate], fanout_index.data() + fanout_offsets[gate + 1]};
+    }
+
+    /**
+     * \brief Returns the Output and Dff pseudo gates in ascending order
+     */
+    const std::vector<gate_t> &Outputs() const { return outputs; }
+
+    const SymbolTable &Symbols() const { return symbols; }
+
+    /**
+     * \brief Bytes allocated for the gate graph, excluding the labels
+     */
+    size_t MemoryUsage() const;
+
+private:
+
+    friend class CircuitBuilder;
+
+    SymbolTable symbols;
+
+    std::vector<gate_type_t> types; ///< Type of each gate
+    std::vector<symbol_t> labels;   ///< Label of each gate
+
+    std::vector<uint32_t> fanin_offsets;  ///< Start of the fanins of each gate, one extra entry at the end
+    std::vector<gate_t> fanin_index;      ///< Fanins of all gates
+    std::vector<uint32_t> fanout_offsets; ///< Start of the fanouts of each gate, one extra entry at the end
+    std::vector<gate_t> fanout_index;     ///< Fanouts of all gates
+
+    std::vector<gate_t> outputs;
+};
+
+/**
+ * \class CircuitBuilder
+ *
+ * \brief Collects the declarations of a netlist and builds the Circuit.
+ *
+ *  Declarations may appear in any order and refer to labels defined later.
+ *   Only the gates reachable from an OUTPUT or a flip flop become part of the
+ *   circuit. If a label is defined twice, the first definition counts.
+ *
+ */
+class CircuitBuilder {
+
+public:
+
+    /**
+     * \brief Symbol table the labels passed to the builder are interned in
+     */
+    SymbolTable &Symbols() { return symbols; }
+
+    void AddInput(symbol_t label);
+
+    void AddOutput(symbol_t label);
+
+    /**
+     * \brief Adds a gate or a flip flop (type Dff) reading the given labels
+     */
+    void AddGate(symbol_t label, gate_type_t type, const std::vector<symbol_t> &inputs);
+
+    /**
+     * \brief Numbers the gates and builds the fanin and fanout arrays
+     * \return Circuit
+     *
+     *  Throws std::runtime_error if a gate reads a label that is never defined.
+     *   The builder is left empty.
+     */
+    Circuit Build();
+
+private:
+
+    struct definition_t {
+        gate_type_t type;
+        uint32_t inputs_begin; ///< Start of the inputs in definition_inputs
+        uint32_t inputs_end;
+    };
+
+    static constexpr uint32_t UNDEFINED = UINT32_MAX;
+
+    SymbolTable symbols;
+    std::vector<symbol_t> output_labels;     ///< Labels declared as OUTPUT
+    std::vector<symbol_t> ff_labels;         ///< Labels of the flip flops
+    std::vector<uint32_t> definition_of;     ///< Index into definitions for each symbol
+    std::vector<definition_t> definitions;
+    std::vector<symbol_t> definition_inputs; ///< Inputs of all definitions
+
+    uint32_t &DefinitionOf(symbol_t label);
+};
+
+/**
+ * \brief Sorts the gates of a circuit topologically
+ * \param circuit the circuit to sort
+ * \return all gates of circuit, every gate after its fanins
+ *
+ *  Kahn's algorithm from the outputs with a counter of unsorted fanouts per
+ *   gate and a stack as work list, so it runs in O(gates + edges). Fanins are
+ *   pushed in descending order so that, on circuits numbered by the
+ *   CircuitBuilder, the result matches the previous std::set based sort that
+ *   always continued with the smallest gate; VDSProject_sort_bench checks this.
+ *   Throws std::runtime_error if the circuit has a cycle.
+ */
+std::vector<gate_t> TopologicalOrder(const Circuit &circuit);
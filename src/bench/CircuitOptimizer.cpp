@@ -0,0 +1,238 @@
+//
+// Structural simplification of a circuit before BDD construction
+//
+
+#include "CircuitOptimizer.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    /* The replacement of a gate is another gate of the circuit or one of these constants */
+    const gate_t CONST0 = UINT32_MAX;
+    const gate_t CONST1 = UINT32_MAX - 1;
+    const gate_t NO_GATE = UINT32_MAX - 2;
+
+    bool IsConstant(gate_t signal) { return signal == CONST0 || signal == CONST1; }
+
+    bool IsOperation(gate_type_t type) {
+        return type == gate_type_t::Not || type == gate_type_t::And || type == gate_type_t::Or ||
+               type == gate_type_t::Nand || type == gate_type_t::Nor || type == gate_type_t::Xor;
+    }
+
+    /* Key of the structural hash: the gate type followed by the sorted fanins */
+    struct gate_key_hash {
+        size_t operator()(const std::vector<gate_t> &key) const {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (gate_t word : key) {
+                hash = (hash ^ word) * 0x100000001b3ULL;
+            }
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+}
+
+Circuit OptimizeCircuit(const Circuit &circuit, const std::vector<gate_t> &order, optimize_stats_t &stats) {
+    stats = optimize_stats_t();
+
+    /* Replacement of each gate; a gate replaced by itself is kept with a new type and fanins */
+    std::vector<gate_t> replacement(circuit.Size(), NO_GATE);
+    std::vector<gate_type_t> kept_type(circuit.Size());
+    std::vector<uint32_t> kept_fanins_begin(circuit.Size()), kept_fanins_end(circuit.Size());
+    std::vector<gate_t> kept_fanins;
+
+    /* The first gate folded to each constant is kept as a constant gate, in
+       case an XOR needs the constant as a fanin */
+    gate_t constant_gate[2] = {NO_GATE, NO_GATE};
+
+    std::unordered_map<std::vector<gate_t>, gate_t, gate_key_hash> structural_hash;
+    std::vector<gate_t> key;
+
+    auto keep = [&](gate_t gate, gate_type_t type, const std::vector<gate_t> &fanins) {
+        key.assign(1, static_cast<gate_t>(type));
+        key.insert(key.end(), fanins.begin(), fanins.end());
+        auto found = structural_hash.emplace(key, gate);
+        if (!found.second) {
+            stats.merged++;
+            return found.first->second;
+        }
+        kept_type[gate] = type;
+        kept_fanins_begin[gate] = static_cast<uint32_t>(kept_fanins.size());
+        kept_fanins.insert(kept_fanins.end(), fanins.begin(), fanins.end());
+        kept_fanins_end[gate] = static_cast<uint32_t>(kept_fanins.size());
+        return gate;
+    };
+
+    auto constant = [&](gate_t gate, bool value) {
+        if (constant_gate[value] == NO_GATE) {
+            constant_gate[value] = gate;
+            kept_type[gate] = value ? gate_type_t::Const1 : gate_type_t::Const0;
+            kept_fanins_begin[gate] = kept_fanins_end[gate] = static_cast<uint32_t>(kept_fanins.size());
+        }
+        return value ? CONST1 : CONST0;
+    };
+
+    auto fold = [&](gate_t gate, bool value) {
+        stats.constants++;
+        return constant(gate, value);
+    };
+
+    auto negate = [&](gate_t gate, gate_t signal) {
+        if (IsConstant(signal)) {
+            return fold(gate, signal == CONST0);
+        }
+        if (kept_type[signal] == gate_type_t::Not) {
+            stats.bypassed++;
+            return kept_fanins[kept_fanins_begin[signal]];
+        }
+        return keep(gate, gate_type_t::Not, {signal});
+    };
+
+    std::vector<gate_t> fanins;
+    for (gate_t gate : order) {
+        gate_type_t type = circuit.Type(gate);
+        if (IsOperation(type)) {
+            stats.operations_before++;
+        }
+
+        fanins.clear();
+        for (gate_t fanin : circuit.Fanins(gate)) {
+            fanins.push_back(replacement[fanin]);
+        }
+        std::sort(fanins.begin(), fanins.end());
+
+        switch (type) {
+            case gate_type_t::Output:
+            case gate_type_t::Dff:
+                continue;
+            case gate_type_t::Input:
+                replacement[gate] = gate;
+                kept_type[gate] = type;
+                break;
+            case gate_type_t::Const0:
+            case gate_type_t::Const1:
+                replacement[gate] = constant(gate, type == gate_type_t::Const1);
+                break;
+            case gate_type_t::Buff:
+                stats.bypassed++;
+                replacement[gate] = fanins[0];
+                break;
+            case gate_type_t::Not:
+                replacement[gate] = negate(gate, fanins[0]);
+                break;
+            case gate_type_t::And:
+            case gate_type_t::Nand:
+            case gate_type_t::Or:
+            case gate_type_t::Nor: {
+                bool conjunction = type == gate_type_t::And || type == gate_type_t::Nand;
+                bool inverted = type == gate_type_t::Nand || type == gate_type_t::Nor;
+                gate_t controlling = conjunction ? CONST0 : CONST1;
+                gate_t neutral = conjunction ? CONST1 : CONST0;
+
+                /* Replacements may coincide; AND and OR are idempotent */
+                fanins.erase(std::unique(fanins.begin(), fanins.end()), fanins.end());
+                if (std::find(fanins.begin(), fanins.end(), controlling) != fanins.end()) {
+                    replacement[gate] = fold(gate, (controlling == CONST1) != inverted);
+                    break;
+                }
+                fanins.erase(std::remove(fanins.begin(), fanins.end(), neutral), fanins.end());
+                if (fanins.empty()) {
+                    replacement[gate] = fold(gate, (neutral == CONST1) != inverted);
+                } else if (fanins.size() == 1) {
+                    if (inverted) {
+                        replacement[gate] = negate(gate, fanins[0]);
+                    } else {
+                        stats.bypassed++;
+                        replacement[gate] = fanins[0];
+                    }
+                } else {
+                    replacement[gate] = keep(gate, conjunction ? (inverted ? gate_type_t::Nand : gate_type_t::And)
+                                                               : (inverted ? gate_type_t::Nor : gate_type_t::Or),
+                                             fanins);
+                }
+                break;
+            }
+            case gate_type_t::Xor: {
+                /* Constants and pairs of equal replacements cancel out, leaving a parity */
+                bool parity = false;
+                size_t kept = 0;
+                for (size_t i = 0; i < fanins.size(); ++i) {
+                    if (IsConstant(fanins[i])) {
+                        parity = parity != (fanins[i] == CONST1);
+                    } else if (i + 1 < fanins.size() && fanins[i + 1] == fanins[i]) {
+                        ++i;
+                    } else {
+                        fanins[kept++] = fanins[i];
+                    }
+                }
+                fanins.resize(kept);
+                if (fanins.empty()) {
+                    replacement[gate] = fold(gate, parity);
+                } else if (fanins.size() == 1) {
+                    if (parity) {
+                        replacement[gate] = negate(gate, fanins[0]);
+                    } else {
+                        stats.bypassed++;
+                        replacement[gate] = fanins[0];
+                    }
+                } else {
+                    if (parity) {
+                        /* A constant 1 fanin exists, so a gate was folded to it */
+                        fanins.push_back(constant_gate[1]);
+                        std::sort(fanins.begin(), fanins.end());
+                    }
+                    replacement[gate] = keep(gate, gate_type_t::Xor, fanins);
+                }
+                break;
+            }
+        }
+    }
+
+    /* Rebuild the circuit. Flip flops are declared first, because the
+       current state of a flip flop is an input of the same label. */
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+    auto label = [&](gate_t gate) { return symbols.Intern(circuit.Label(gate)); };
+
+    std::vector<symbol_t> inputs;
+    for (gate_t gate : circuit.Outputs()) {
+        if (circuit.Type(gate) == gate_type_t::Dff) {
+            inputs.clear();
+            for (gate_t fanin : circuit.Fanins(gate)) {
+                inputs.push_back(label(fanin));
+            }
+            builder.AddGate(label(gate), gate_type_t::Dff, inputs);
+        } else {
+            builder.AddOutput(label(gate));
+        }
+    }
+    for (gate_t gate : order) {
+        gate_t signal = replacement[gate];
+        if (signal == NO_GATE) {
+            continue;
+        }
+        if (signal == gate) {
+            if (kept_type[gate] == gate_type_t::Input) {
+                builder.AddInput(label(gate));
+                continue;
+            }
+            inputs.clear();
+            for (uint32_t fanin = kept_fanins_begin[gate]; fanin < kept_fanins_end[gate]; ++fanin) {
+                inputs.push_back(label(kept_fanins[fanin]));
+            }
+            builder.AddGate(label(gate), kept_type[gate], inputs);
+        } else if (IsConstant(signal)) {
+            builder.AddGate(label(gate), signal == CONST1 ? gate_type_t::Const1 : gate_type_t::Const0, {});
+        } else {
+            builder.AddGate(label(gate), gate_type_t::Buff, {label(signal)});
+        }
+    }
+    Circuit optimized = builder.Build();
+
+    for (gate_t gate = 0; gate < optimized.Size(); ++gate) {
+        if (IsOperation(optimized.Type(gate))) {
+            stats.operations_after++;
+        }
+    }
+    return optimized;
+}
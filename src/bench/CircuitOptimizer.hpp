@@ -0,0 +1,45 @@
+//
+// Structural simplification of a circuit before BDD construction
+//
+
+#pragma once
+
+#include "Circuit.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * \struct optimize_stats_t
+ * \brief What OptimizeCircuit removed from a circuit
+ */
+struct optimize_stats_t {
+    size_t operations_before = 0; ///< Gates that need a BDD operation (NOT, AND, OR, NAND, NOR, XOR) before
+    size_t operations_after = 0;  ///< The same after the optimization
+    size_t merged = 0;            ///< Gates equal to an earlier gate of the same type and fanins
+    size_t bypassed = 0;          ///< BUFF gates, single input gates and double inversions
+    size_t constants = 0;         ///< Gates whose value turned out to be constant
+};
+
+/**
+ * \brief Simplifies a circuit without changing the function of any remaining label
+ * \param circuit the circuit to simplify
+ * \param order the gates of circuit in topological order
+ * \param stats receives the number of gates removed by each rule
+ * \return Circuit
+ *
+ *  In one pass over the gates in topological order:
+ *   - constants are propagated: a controlling constant fanin decides the
+ *     gate, other constant fanins are dropped;
+ *   - BUFF gates, gates left with a single fanin and NOT(NOT(x)) are
+ *     replaced by the gate they pass on;
+ *   - gates with the same type and the same fanins, after the rules above,
+ *     are merged (structural hashing).
+ *
+ *  The result keeps the labels of the outputs and flip flops. A removed gate
+ *   that is still read by one of them becomes a BUFF of its replacement or a
+ *   constant, which GenerateBDD resolves without a Manager call; all other
+ *   removed gates, and the gates only they read, are dropped. Gates are
+ *   numbered anew, so the variable order may change.
+ */
+Circuit OptimizeCircuit(const Circuit &circuit, const std::vector<gate_t> &order, optimize_stats_t &stats);
@@ -0,0 +1,200 @@
+//
+// Bit-parallel random simulation of a circuit
+//
+
+#include "CircuitSimulator.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+    /* SplitMix64, a small generator whose outputs pass the usual statistical tests */
+    uint64_t NextRandom(uint64_t &state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+}
+
+CircuitSimulator::CircuitSimulator(const Circuit &circuit, const std::vector<gate_t> &order, unsigned words)
+        : circuit(circuit), order(order), words(words) {
+    if (words != 1 && words != 2 && words != 4 && words != 8) {
+        throw std::invalid_argument("CircuitSimulator: words per pass must be 1, 2, 4 or 8");
+    }
+    for (gate_t gate : order) {
+        if (circuit.Type(gate) == gate_type_t::Input) {
+            inputs.push_back(gate);
+        }
+    }
+    values.assign(circuit.Size() * words, 0);
+    ones.assign(circuit.Size(), 0);
+    toggles.assign(circuit.Size(), 0);
+    last_bit.assign(circuit.Size(), 0);
+}
+
+void CircuitSimulator::Run(size_t passes, uint64_t seed) {
+    uint64_t random_state = seed;
+    for (size_t pass = 0; pass < passes; ++pass) {
+        switch (words) {
+            case 1:
+                Pass<1>(random_state);
+                break;
+            case 2:
+                Pass<2>(random_state);
+                break;
+            case 4:
+                Pass<4>(random_state);
+                break;
+            default:
+                Pass<8>(random_state);
+                break;
+        }
+    }
+}
+
+template<unsigned W>
+void CircuitSimulator::Pass(uint64_t &random_state) {
+    for (gate_t input : inputs) {
+        for (unsigned w = 0; w < W; ++w) {
+            values[input * W + w] = NextRandom(random_state);
+        }
+    }
+
+    bool first_pass = patterns == 0;
+    for (gate_t gate : order) {
+        uint64_t *out = &values[gate * W];
+        gate_range_t fanins = circuit.Fanins(gate);
+        uint64_t block[W];
+
+        switch (circuit.Type(gate)) {
+            case gate_type_t::Input:
+                break;
+            case gate_type_t::Const0:
+            case gate_type_t::Const1: {
+                uint64_t constant = circuit.Type(gate) == gate_type_t::Const1 ? ~0ULL : 0;
+                for (unsigned w = 0; w < W; ++w) out[w] = constant;
+                break;
+            }
+            case gate_type_t::Output:
+            case gate_type_t::Dff:
+            case gate_type_t::Buff:
+            case gate_type_t::Not: {
+                const uint64_t *in = &values[fanins[0] * W];
+                uint64_t invert = circuit.Type(gate) == gate_type_t::Not ? ~0ULL : 0;
+                for (unsigned w = 0; w < W; ++w) out[w] = in[w] ^ invert;
+                break;
+            }
+            case gate_type_t::And:
+            case gate_type_t::Nand: {
+                for (unsigned w = 0; w < W; ++w) block[w] = ~0ULL;
+                for (gate_t fanin : fanins) {
+                    const uint64_t *in = &values[fanin * W];
+                    for (unsigned w = 0; w < W; ++w) block[w] &= in[w];
+                }
+                uint64_t invert = circuit.Type(gate) == gate_type_t::Nand ? ~0ULL : 0;
+                for (unsigned w = 0; w < W; ++w) out[w] = block[w] ^ invert;
+                break;
+            }
+            case gate_type_t::Or:
+            case gate_type_t::Nor: {
+                for (unsigned w = 0; w < W; ++w) block[w] = 0;
+                for (gate_t fanin : fanins) {
+                    const uint64_t *in = &values[fanin * W];
+                    for (unsigned w = 0; w < W; ++w) block[w] |= in[w];
+                }
+                uint64_t invert = circuit.Type(gate) == gate_type_t::Nor ? ~0ULL : 0;
+                for (unsigned w = 0; w < W; ++w) out[w] = block[w] ^ invert;
+                break;
+            }
+            case gate_type_t::Xor: {
+                for (unsigned w = 0; w < W; ++w) block[w] = 0;
+                for (gate_t fanin : fanins) {
+                    const uint64_t *in = &values[fanin * W];
+                    for (unsigned w = 0; w < W; ++w) block[w] ^= in[w];
+                }
+                for (unsigned w = 0; w < W; ++w) out[w] = block[w];
+                break;
+            }
+        }
+
+        /* Pattern i is bit i % 64 of word i / 64; a toggle is a bit that
+           differs from the one before it, carried over from the last pass */
+        uint64_t previous = first_pass ? out[0] & 1 : last_bit[gate];
+        for (unsigned w = 0; w < W; ++w) {
+            ones[gate] += static_cast<uint64_t>(__builtin_popcountll(out[w]));
+            toggles[gate] += static_cast<uint64_t>(__builtin_popcountll(out[w] ^ ((out[w] << 1) | previous)));
+            previous = out[w] >> 63;
+        }
+        last_bit[gate] = previous;
+    }
+    patterns += 64 * W;
+}
+
+double CircuitSimulator::SignalProbability(gate_t gate) const {
+    return patterns == 0 ? 0.0 : static_cast<double>(ones[gate]) / static_cast<double>(patterns);
+}
+
+double CircuitSimulator::ToggleRate(gate_t gate) const {
+    return patterns < 2 ? 0.0 : static_cast<double>(toggles[gate]) / static_cast<double>(patterns - 1);
+}
+
+void CircuitSimulator::WriteReport(const std::string &csv_file) const {
+    std::ofstream out(csv_file);
+    if (!out.is_open()) {
+        throw std::runtime_error("Unable to open " + csv_file);
+    }
+    out << "Bench Label,Type,Signal Probability,Toggle Rate\n";
+    for (gate_t gate : order) {
+        if (circuit.Type(gate) != gate_type_t::Output && circuit.Type(gate) != gate_type_t::Dff) {
+            out << circuit.Label(gate) << "," << GateTypeName(circuit.Type(gate)) << "," << SignalProbability(gate)
+                << "," << ToggleRate(gate) << "\n";
+        }
+    }
+}
+
+size_t CircuitSimulator::CheckBDDs(ClassProject::ManagerInterface &manager,
+                                   const std::map<std::string, ClassProject::BDD_ID> &outputs) const {
+    /* Outputs are named after the gate they read, variables after their input */
+    std::unordered_map<std::string_view, gate_t> gate_of_label;
+    for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+        if (circuit.Type(gate) != gate_type_t::Output && circuit.Type(gate) != gate_type_t::Dff) {
+            gate_of_label.emplace(circuit.Label(gate), gate);
+        }
+    }
+    std::unordered_map<ClassProject::BDD_ID, gate_t> input_of_var;
+    auto input_of = [&](ClassProject::BDD_ID node) {
+        ClassProject::BDD_ID var = manager.topVar(node);
+        auto found = input_of_var.find(var);
+        if (found == input_of_var.end()) {
+            std::string label = manager.getTopVarName(node);
+            auto input = gate_of_label.find(label);
+            if (input == gate_of_label.end() || circuit.Type(input->second) != gate_type_t::Input) {
+                throw std::runtime_error("CheckBDDs: variable '" + label + "' is not an input of the circuit");
+            }
+            found = input_of_var.emplace(var, input->second).first;
+        }
+        return found->second;
+    };
+
+    size_t pass_patterns = patterns == 0 ? 0 : PatternsPerPass();
+    size_t mismatches = 0;
+    for (const auto &output : outputs) {
+        auto gate = gate_of_label.find(output.first);
+        if (gate == gate_of_label.end()) {
+            throw std::runtime_error("CheckBDDs: output '" + output.first + "' is not a gate of the circuit");
+        }
+        for (size_t pattern = 0; pattern < pass_patterns; ++pattern) {
+            ClassProject::BDD_ID node = output.second;
+            while (!manager.isConstant(node)) {
+                node = Value(input_of(node), pattern) ? manager.coFactorTrue(node) : manager.coFactorFalse(node);
+            }
+            if ((node == manager.True()) != Value(gate->second, pattern)) {
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
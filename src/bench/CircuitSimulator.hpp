@@ -0,0 +1,113 @@
+//
+// Bit-parallel random simulation of a circuit
+//
+
+#pragma once
+
+#include "Circuit.hpp"
+#include "../ManagerInterface.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * \class CircuitSimulator
+ *
+ * \brief Evaluates a circuit on random input patterns, 64 patterns per machine word.
+ *
+ *  Every gate holds one block of 1, 2, 4 or 8 words per pass, so one pass
+ *   evaluates 64 to 512 patterns with a few word operations per gate and
+ *   fanin. The block size is a template parameter of the pass, so the loops
+ *   over a block have a fixed length and are vectorized by the compiler.
+ *   Inputs, including the current states of flip flops, get uniformly random
+ *   values.
+ *
+ *  Over all passes the simulator counts, per gate, the patterns in which the
+ *   gate is 1 and the changes of its value between consecutive patterns. The
+ *   values of the last pass are kept to cross-check BDDs built for the same
+ *   circuit.
+ *
+ */
+class CircuitSimulator {
+
+public:
+
+    static constexpr unsigned MAX_WORDS = 8; ///< At most 512 patterns per pass
+
+    /**
+     * \param circuit the circuit to simulate, must outlive the simulator
+     * \param order the gates of circuit in topological order
+     * \param words 64 bit words of patterns per pass: 1, 2, 4 or 8
+     *
+     *  Throws std::invalid_argument for other numbers of words.
+     */
+    CircuitSimulator(const Circuit &circuit, const std::vector<gate_t> &order, unsigned words = 4);
+
+    /**
+     * \brief Simulates further passes of random patterns
+     * \param passes the number of passes
+     * \param seed seed of the pattern generator; the same seed gives the same patterns
+     */
+    void Run(size_t passes, uint64_t seed);
+
+    size_t PatternsPerPass() const { return 64 * words; }
+
+    /**
+     * \brief Patterns simulated by all calls to Run so far
+     */
+    size_t Patterns() const { return patterns; }
+
+    /**
+     * \brief Fraction of the simulated patterns in which the gate is 1
+     */
+    double SignalProbability(gate_t gate) const;
+
+    /**
+     * \brief Fraction of consecutive pattern pairs in which the gate changes its value
+     */
+    double ToggleRate(gate_t gate) const;
+
+    /**
+     * \brief Value of a gate in one pattern of the last pass
+     */
+    bool Value(gate_t gate, size_t pattern) const {
+        return (values[gate * words + pattern / 64] >> (pattern % 64)) & 1;
+    }
+
+    /**
+     * \brief Writes the signal probability and toggle rate of every gate to a csv file
+     * \param csv_file the file to write to
+     */
+    void WriteReport(const std::string &csv_file) const;
+
+    /**
+     * \brief Compares output BDDs with the patterns of the last pass
+     * \param manager the manager the BDDs belong to
+     * \param outputs output labels and their BDDs, as returned by CircuitToBDD::GetOutputBDDs
+     * \return the number of (output, pattern) pairs in which the BDD disagrees with the simulation
+     *
+     *  Each BDD is evaluated by following the edge selected by the simulated
+     *   value of its top variable's input. Variables are matched to inputs by
+     *   label. Throws std::runtime_error for labels or variables not in the circuit.
+     */
+    size_t CheckBDDs(ClassProject::ManagerInterface &manager,
+                     const std::map<std::string, ClassProject::BDD_ID> &outputs) const;
+
+private:
+
+    const Circuit &circuit;
+    const std::vector<gate_t> &order;
+    const unsigned words;
+
+    std::vector<gate_t> inputs;     ///< Gates of type Input
+    std::vector<uint64_t> values;   ///< The words of each gate in the last pass
+    std::vector<uint64_t> ones;     ///< Per gate, simulated patterns in which it was 1
+    std::vector<uint64_t> toggles;  ///< Per gate, value changes between consecutive patterns
+    std::vector<uint64_t> last_bit; ///< Per gate, the value in the last simulated pattern
+    size_t patterns = 0;
+
+    template<unsigned W>
+    void Pass(uint64_t &random_state);
+};
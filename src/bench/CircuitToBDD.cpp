@@ -5,8 +5,57 @@
 
 #include "CircuitToBDD.hpp"
 
+#include "BoundedQueue.hpp"
+
 #include <utility>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    const char *const DECOMPOSITION_NAMES[] = {"linear", "balanced", "greedy"};
+
+    /* With early release, no garbage is collected before the manager has this many live nodes */
+    const size_t MIN_COLLECTION_NODES = 1 << 16;
+
+    void AppendNumber(std::string &out, uint64_t value) {
+        char digits[20];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        out.append(digits, end);
+    }
 
+    void WriteWholeFile(const std::string &file_name, const std::string &contents) {
+        std::ofstream out(file_name, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Unable to open Log File!");
+        }
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!out) {
+            throw std::runtime_error("Unable to write " + file_name);
+        }
+    }
+}
+
+const char *DecompositionName(decomposition_t decomposition) {
+    return DECOMPOSITION_NAMES[static_cast<size_t>(decomposition)];
+}
+
+bool ParseDecomposition(const std::string &name, decomposition_t &decomposition) {
+    for (size_t i = 0; i < sizeof(DECOMPOSITION_NAMES) / sizeof(DECOMPOSITION_NAMES[0]); ++i) {
+        if (name == DECOMPOSITION_NAMES[i]) {
+            decomposition = static_cast<decomposition_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
 
 CircuitToBDD::CircuitToBDD(shared_ptr<ClassProject::ManagerInterface> BDD_manager_p) {
     bdd_manager = std::move(BDD_manager_p);
@@ -14,15 +63,159 @@ CircuitToBDD::CircuitToBDD(shared_ptr<ClassProject::ManagerInterface> BDD_manage
 
 CircuitToBDD::~CircuitToBDD() = default;
 
-void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::string& benchmark_file) {
+void CircuitToBDD::GenerateBDD(const Circuit &circuit, const std::vector<gate_t> &order,
+                               const std::string& benchmark_file) {
     ClassProject::BDD_ID BDD_node;
 
+    std::ofstream bdd_out_file = OpenGateLog(benchmark_file);
+
+    gate_to_bdd_id.assign(circuit.Size(), 0);
+    bool has_restored_gates = !label_to_bdd_id.empty();
+    auto last_checkpoint = std::chrono::steady_clock::now();
+
+    /* With early release, the fanouts of each gate that are not built yet */
+    std::vector<uint32_t> remaining_fanouts;
+    std::vector<ClassProject::BDD_ID> live_roots;
+    size_t collection_threshold = MIN_COLLECTION_NODES, collections = 0, released = 0, freed = 0;
+    if (early_release) {
+        if (has_restored_gates) {
+            throw std::runtime_error("Early release cannot be combined with restored gates");
+        }
+        remaining_fanouts.resize(circuit.Size());
+        for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+            remaining_fanouts[gate] = static_cast<uint32_t>(circuit.Fanouts(gate).size());
+        }
+    }
+
+    for (gate_t gate : order) {
+        gate_type_t gate_type = circuit.Type(gate);
+
+        /* OUTPUT or FLIP FLOP gates do not generate a BDD */
+        if (gate_type == gate_type_t::Output || gate_type == gate_type_t::Dff) {
+            continue;
+        }
+
+        label_t label(circuit.Label(gate));
+
+        /* Gates restored from a previous run are not built again */
+        auto restored = has_restored_gates ? label_to_bdd_id.find(label) : label_to_bdd_id.end();
+        if (restored != label_to_bdd_id.end()) {
+            BDD_node = restored->second;
+        } else {
+            BDD_node = BuildGate(circuit, gate);
+        }
+
+        gate_to_bdd_id[gate] = BDD_node;
+        label_to_bdd_id.emplace(std::move(label), BDD_node);
+        bdd_out_file << BDD_node << "," << circuit.Label(gate) << "\n";
+
+        if (early_release) {
+            /* Outputs and flip flops are never built, so the gates they read are never released.
+               A gate nothing reads is released at once, its BDD is no root of the next collection. */
+            for (gate_t fanin : circuit.Fanins(gate)) {
+                if (--remaining_fanouts[fanin] == 0) {
+                    label_to_bdd_id.erase(label_t(circuit.Label(fanin)));
+                    released++;
+                }
+            }
+            if (remaining_fanouts[gate] == 0) {
+                label_to_bdd_id.erase(label_t(circuit.Label(gate)));
+                released++;
+            }
+            if (bdd_manager->liveNodeCount() >= collection_threshold) {
+                live_roots.clear();
+                for (gate_t live_gate = 0; live_gate < circuit.Size(); ++live_gate) {
+                    if (remaining_fanouts[live_gate] > 0) {
+                        live_roots.push_back(gate_to_bdd_id[live_gate]);
+                    }
+                }
+                freed += bdd_manager->collectGarbage(live_roots);
+                collections++;
+                collection_threshold = std::max(MIN_COLLECTION_NODES, 2 * bdd_manager->liveNodeCount());
+            }
+        }
+
+        if (checkpoint_hook && std::chrono::steady_clock::now() - last_checkpoint >= checkpoint_interval) {
+            bdd_out_file.flush();
+            checkpoint_hook();
+            last_checkpoint = std::chrono::steady_clock::now();
+        }
+    }
+
+    bdd_out_file.close();
+    if (early_release) {
+        std::cout << " " << released << " gates released, " << collections << " collections freed " << freed
+                  << " nodes...";
+    }
+}
+
+
+ClassProject::BDD_ID CircuitToBDD::BuildGate(const Circuit &circuit, gate_t gate) {
+    gate_type_t gate_type = circuit.Type(gate);
+    gate_range_t fanins = circuit.Fanins(gate);
+    switch (gate_type) {
+        case gate_type_t::Input:
+            return InputGate(label_t(circuit.Label(gate)));
+        case gate_type_t::Not:
+            return NotGate(fanins);
+        case gate_type_t::And:
+            return AndGate(fanins);
+        case gate_type_t::Or:
+            return OrGate(fanins);
+        case gate_type_t::Nand:
+            return NandGate(fanins);
+        case gate_type_t::Nor:
+            return NorGate(fanins);
+        case gate_type_t::Xor:
+            return XorGate(fanins);
+        case gate_type_t::Buff:
+            return findBddId(fanins[0]);
+        case gate_type_t::Const0:
+            return bdd_manager->False();
+        case gate_type_t::Const1:
+            return bdd_manager->True();
+        default:
+            throw std::runtime_error("Unexpected gate type " + std::string(GateTypeName(gate_type)));
+    }
+}
+
+ClassProject::BDD_ID CircuitToBDD::BuildCone(const Circuit &circuit, gate_t gate) {
+    if (cone_built.size() != circuit.Size()) {
+        gate_to_bdd_id.assign(circuit.Size(), 0);
+        cone_built.assign(circuit.Size(), false);
+    }
+
+    /* Post-order over the fanins that are not built yet; a flip flop's current
+       state is an input, so cones end at inputs and constants */
+    std::vector<std::pair<gate_t, bool>> stack{{gate, false}};
+    while (!stack.empty()) {
+        auto [current, expanded] = stack.back();
+        stack.pop_back();
+        if (cone_built[current]) {
+            continue;
+        }
+        if (expanded) {
+            gate_to_bdd_id[current] = BuildGate(circuit, current);
+            cone_built[current] = true;
+            continue;
+        }
+        stack.emplace_back(current, true);
+        for (gate_t fanin : circuit.Fanins(current)) {
+            if (!cone_built[fanin]) {
+                stack.emplace_back(fanin, false);
+            }
+        }
+    }
+    return gate_to_bdd_id[gate];
+}
+
+std::ofstream CircuitToBDD::OpenGateLog(const std::string &benchmark_file) {
     std::filesystem::path pathToBenchFile(benchmark_file);
     if (!pathToBenchFile.has_filename())
         throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file not specified");
     if (!std::filesystem::exists(benchmark_file))
         throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file doesn't exist");
-    result_dir = "results_" + pathToBenchFile.stem().string();
+    result_dir = ResultDir(benchmark_file);
 
     if (!(std::filesystem::exists(result_dir)) && !std::filesystem::create_directory(result_dir)) {
         throw std::runtime_error("Unable to create directory 'result' for the output!");
@@ -35,44 +228,406 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
     }
 
     bdd_out_file << "BDD_ID,Bench Label" << std::endl;
+    return bdd_out_file;
+}
+
+namespace {
+    /* A statement handed from the parser thread to the BDD builder. The name
+       views the chunked storage of the symbol table, which stays valid while
+       the parser keeps adding labels; the table itself is not shared. */
+    struct streamed_statement_t {
+        bench_statement_t statement;
+        std::string_view name;
+    };
+
+    typedef std::vector<streamed_statement_t> statement_batch_t;
+
+    const size_t STREAM_BATCH_SIZE = 256;   ///< Statements per queue entry, to keep locking rare
+    const size_t STREAM_QUEUE_BATCHES = 64; ///< Queue entries the parser may run ahead
 
-    for (const auto &circuit_node : circuit) {
-        if (circuit_node.gate_type == INPUT_GATE_T) {
-            BDD_node = InputGate(circuit_node.label);
-        } else if (circuit_node.gate_type == NOT_GATE_T) {
-            BDD_node = NotGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == AND_GATE_T) {
-            BDD_node = AndGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == OR_GATE_T) {
-            BDD_node = OrGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == NAND_GATE_T) {
-            BDD_node = NandGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == NOR_GATE_T) {
-            BDD_node = NorGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == XOR_GATE_T) {
-            BDD_node = XorGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == BUFFER_GATE_T) {
-            BDD_node = findBddId(*circuit_node.input_id_list.begin());
+    const uint32_t NO_WAITER = UINT32_MAX;
+}
+
+std::set<label_t> CircuitToBDD::StreamBDD(const std::string &benchmark_file) {
+    std::ofstream bdd_out_file = OpenGateLog(benchmark_file);
+
+    MappedFile file(benchmark_file);
+    SymbolTable symbols;
+    BoundedQueue<statement_batch_t> queue(STREAM_QUEUE_BATCHES);
+    std::exception_ptr parse_error;
+
+    std::thread parser([&]() {
+        try {
+            BenchTokenizer tokenizer(file.begin(), file.end(), symbols);
+            statement_batch_t batch;
+            streamed_statement_t item;
+            while (tokenizer.Next(item.statement)) {
+                item.name = symbols.Name(item.statement.label);
+                batch.push_back(item);
+                if (batch.size() == STREAM_BATCH_SIZE) {
+                    if (!queue.Push(std::move(batch))) {
+                        break;
+                    }
+                    batch = statement_batch_t();
+                }
+            }
+            if (!batch.empty()) {
+                queue.Push(std::move(batch));
+            }
+        } catch (...) {
+            parse_error = std::current_exception();
+        }
+        queue.Close();
+    });
+
+    /* Per symbol: not read yet, a gate waiting for fanins, an input whose
+       variable is created when a gate reads it first, or a built BDD. Creating
+       variables in the order gates use them, rather than in declaration
+       order, keeps related variables close together in the order. */
+    enum : uint8_t { UNDEFINED, PENDING, INPUT, BUILT };
+    std::vector<uint8_t> state;
+    std::vector<std::string_view> input_name;
+    std::vector<uint32_t> first_waiter; ///< Head of the list of pending gates reading the symbol
+
+    struct pending_gate_t {
+        symbol_t label;
+        gate_type_t type;
+        uint32_t fanins_begin;
+        uint32_t fanins_end;
+        uint32_t missing; ///< Fanins not built yet
+        std::string_view name;
+    };
+    struct waiter_t {
+        uint32_t gate; ///< Index into pending
+        uint32_t next;
+    };
+    std::vector<pending_gate_t> pending;
+    std::vector<symbol_t> pending_fanins;
+    std::vector<waiter_t> waiters;
+    std::vector<uint32_t> ready; ///< Pending gates whose fanins are all built
+    std::vector<symbol_t> output_symbols;
+    size_t statements = 0, waited = 0, waiting = 0, peak_waiting = 0;
+
+    auto grow = [&](symbol_t symbol) {
+        if (symbol >= state.size()) {
+            size_t size = std::max<size_t>(symbol + 1, state.size() * 2);
+            state.resize(size, UNDEFINED);
+            input_name.resize(size);
+            first_waiter.resize(size, NO_WAITER);
+            gate_to_bdd_id.resize(size, 0);
         }
+    };
 
-        /* OUTPUT or FLIP FLOP gates do not generate a BDD */
-        if (!((circuit_node.gate_type == OUTPUT_GATE_T) | (circuit_node.gate_type == FLIP_FLOP_GATE_T))) {
-            node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(circuit_node.id, BDD_node));
-            label_to_bdd_id.insert(std::pair<label_t, ClassProject::BDD_ID>(circuit_node.label, BDD_node));
-            bdd_out_file << BDD_node << "," << circuit_node.label << std::endl;
+    auto wake_waiters = [&](symbol_t label) {
+        for (uint32_t waiter = first_waiter[label]; waiter != NO_WAITER; waiter = waiters[waiter].next) {
+            if (--pending[waiters[waiter].gate].missing == 0) {
+                ready.push_back(waiters[waiter].gate);
+            }
+        }
+        first_waiter[label] = NO_WAITER;
+    };
+
+    auto define = [&](symbol_t label, ClassProject::BDD_ID BDD_node, std::string_view name) {
+        state[label] = BUILT;
+        gate_to_bdd_id[label] = BDD_node;
+        label_to_bdd_id.emplace(name, BDD_node);
+        bdd_out_file << BDD_node << "," << name << "\n";
+        wake_waiters(label);
+    };
+
+    auto create_variable = [&](symbol_t label) {
+        if (state[label] == INPUT) {
+            define(label, InputGate(label_t(input_name[label])), input_name[label]);
+        }
+    };
+
+    /* Symbols serve as gate indices, so the gate functions find the fanin BDDs in gate_to_bdd_id */
+    auto build = [&](gate_type_t type, gate_range_t fanins) {
+        for (symbol_t fanin : fanins) {
+            create_variable(fanin);
+        }
+        switch (type) {
+            case gate_type_t::Buff:
+                return findBddId(fanins[0]);
+            case gate_type_t::Not:
+                return NotGate(fanins);
+            case gate_type_t::And:
+                return AndGate(fanins);
+            case gate_type_t::Or:
+                return OrGate(fanins);
+            case gate_type_t::Nand:
+                return NandGate(fanins);
+            case gate_type_t::Nor:
+                return NorGate(fanins);
+            case gate_type_t::Xor:
+                return XorGate(fanins);
+            default:
+                throw std::runtime_error("Unexpected gate type " + std::string(GateTypeName(type)));
+        }
+    };
+
+    try {
+        statement_batch_t batch;
+        std::vector<symbol_t> fanins;
+        while (queue.Pop(batch)) {
+            for (auto &item : batch) {
+                const bench_statement_t &statement = item.statement;
+                statements++;
+                grow(statement.label);
+                for (symbol_t input : statement.inputs) {
+                    grow(input);
+                }
+
+                gate_type_t type;
+                if (!ParseGateType(statement.gate_type, type)) {
+                    throw bench_syntax_error(statement.line, "unknown gate type " + std::string(statement.gate_type));
+                }
+                if (type == gate_type_t::Output) {
+                    output_symbols.push_back(statement.label);
+                    continue;
+                }
+                if (state[statement.label] != UNDEFINED) {
+                    continue;
+                }
+                if (type == gate_type_t::Dff) {
+                    /* The next-state function is an output, the current state an input */
+                    output_symbols.push_back(statement.inputs[0]);
+                }
+                if (type == gate_type_t::Input || type == gate_type_t::Dff) {
+                    state[statement.label] = INPUT;
+                    input_name[statement.label] = item.name;
+                    wake_waiters(statement.label);
+                } else {
+                    fanins = statement.inputs;
+                    std::sort(fanins.begin(), fanins.end());
+                    fanins.erase(std::unique(fanins.begin(), fanins.end()), fanins.end());
+
+                    uint32_t missing = 0;
+                    for (symbol_t fanin : fanins) {
+                        missing += state[fanin] < INPUT;
+                    }
+                    if (missing == 0) {
+                        define(statement.label, build(type, {fanins.data(), fanins.data() + fanins.size()}),
+                               item.name);
+                    } else {
+                        auto gate = static_cast<uint32_t>(pending.size());
+                        auto fanins_begin = static_cast<uint32_t>(pending_fanins.size());
+                        pending_fanins.insert(pending_fanins.end(), fanins.begin(), fanins.end());
+                        pending.push_back({statement.label, type, fanins_begin,
+                                           static_cast<uint32_t>(pending_fanins.size()), missing, item.name});
+                        for (symbol_t fanin : fanins) {
+                            if (state[fanin] < INPUT) {
+                                waiters.push_back({gate, first_waiter[fanin]});
+                                first_waiter[fanin] = static_cast<uint32_t>(waiters.size() - 1);
+                            }
+                        }
+                        state[statement.label] = PENDING;
+                        waited++;
+                        peak_waiting = std::max(peak_waiting, ++waiting);
+                    }
+                }
+
+                /* Building a gate may complete the fanins of gates waiting for it */
+                while (!ready.empty()) {
+                    const pending_gate_t gate = pending[ready.back()];
+                    ready.pop_back();
+                    waiting--;
+                    const symbol_t *gate_fanins = pending_fanins.data();
+                    define(gate.label, build(gate.type, {gate_fanins + gate.fanins_begin, gate_fanins + gate.fanins_end}),
+                           gate.name);
+                }
+            }
         }
+    } catch (...) {
+        queue.Close();
+        parser.join();
+        throw;
+    }
+    parser.join();
+    if (parse_error) {
+        std::rethrow_exception(parse_error);
     }
 
+    /* The parser is done, so the symbol table may be read from here on */
+    std::set<label_t> output_labels;
+    for (symbol_t output : output_symbols) {
+        if (state[output] == UNDEFINED) {
+            throw std::runtime_error("There is no mapping from label '" + std::string(symbols.Name(output)) +
+                                     "' to a node.");
+        }
+        /* An output may read an input directly */
+        create_variable(output);
+        output_labels.emplace(symbols.Name(output));
+    }
     bdd_out_file.close();
+    for (const auto &gate : pending) {
+        if (gate.missing == 0) {
+            continue;
+        }
+        for (uint32_t fanin = gate.fanins_begin; fanin < gate.fanins_end; ++fanin) {
+            if (state[pending_fanins[fanin]] == UNDEFINED) {
+                throw std::runtime_error("There is no mapping from label '" +
+                                         std::string(symbols.Name(pending_fanins[fanin])) + "' to a node.");
+            }
+        }
+        throw std::runtime_error("The circuit must be cycle free!");
+    }
+
+    std::cout << " " << statements << " statements, " << waited << " gates waited for a fanin (at most "
+              << peak_waiting << " at a time)...";
+    return output_labels;
+}
+
+std::string CircuitToBDD::ResultDir(const std::string &benchmark_file) {
+    return "results_" + std::filesystem::path(benchmark_file).stem().string();
+}
+
+void CircuitToBDD::SaveGateMap(const std::string &csv_file) const {
+    std::string tmp = csv_file + ".tmp";
+    {
+        std::ofstream out(tmp);
+        if (!out.is_open()) {
+            throw std::runtime_error("Unable to open " + tmp);
+        }
+        out << "BDD_ID,Bench Label\n";
+        for (const auto &gate : label_to_bdd_id) {
+            out << gate.second << "," << gate.first << "\n";
+        }
+        if (!out.flush()) {
+            throw std::runtime_error("Unable to write " + tmp);
+        }
+    }
+    std::filesystem::rename(tmp, csv_file);
+}
+
+size_t CircuitToBDD::RestoreGateMap(const std::string &csv_file, size_t node_count) {
+    std::ifstream csv(csv_file);
+    if (!csv.is_open()) {
+        throw std::runtime_error("Unable to open " + csv_file);
+    }
+
+    std::string line;
+    std::getline(csv, line); /* header */
+    size_t restored = 0;
+    while (std::getline(csv, line)) {
+        auto comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        ClassProject::BDD_ID id = std::stoull(line.substr(0, comma));
+        if (id < node_count && label_to_bdd_id.emplace(line.substr(comma + 1), id).second) {
+            restored++;
+        }
+    }
+    return restored;
+}
+
+void CircuitToBDD::SetCheckpointHook(std::function<void()> hook, std::chrono::seconds interval) {
+    checkpoint_hook = std::move(hook);
+    checkpoint_interval = interval;
+}
+
+void CircuitToBDD::SetDecomposition(decomposition_t strategy) {
+    decomposition = strategy;
+}
+
+void CircuitToBDD::SetEarlyRelease(bool enable) {
+    early_release = enable;
+}
+
+namespace {
+    /* "<type> <fanin label> ..." with the fanin labels sorted, so that the
+       signature does not depend on the gate numbering of a particular run */
+    std::string GateSignature(const Circuit &circuit, gate_t gate) {
+        std::vector<std::string_view> fanin_labels;
+        for (gate_t fanin : circuit.Fanins(gate)) {
+            fanin_labels.push_back(circuit.Label(fanin));
+        }
+        std::sort(fanin_labels.begin(), fanin_labels.end());
+
+        std::string signature = GateTypeName(circuit.Type(gate));
+        for (const auto &fanin_label : fanin_labels) {
+            signature += " ";
+            signature += fanin_label;
+        }
+        return signature;
+    }
+
+    bool IsBddGate(const Circuit &circuit, gate_t gate) {
+        return !(circuit.Type(gate) == gate_type_t::Output || circuit.Type(gate) == gate_type_t::Dff);
+    }
 }
 
+void CircuitToBDD::SaveCircuitSignature(const Circuit &circuit, const std::vector<gate_t> &order,
+                                        const std::string &signature_file) {
+    std::ofstream out(signature_file);
+    if (!out.is_open()) {
+        throw std::runtime_error("Unable to open " + signature_file);
+    }
+
+    for (gate_t gate : order) {
+        if (IsBddGate(circuit, gate)) {
+            out << circuit.Label(gate) << " " << GateSignature(circuit, gate) << "\n";
+        }
+    }
+}
+
+size_t CircuitToBDD::InvalidateChangedGates(const Circuit &circuit, const std::vector<gate_t> &order,
+                                            const std::string &signature_file) {
+    std::ifstream in(signature_file);
+    if (!in.is_open()) {
+        throw std::runtime_error("Unable to open " + signature_file);
+    }
+
+    std::unordered_map<label_t, std::string> previous_signature;
+    std::string line;
+    while (std::getline(in, line)) {
+        auto space = line.find(' ');
+        if (space != std::string::npos) {
+            previous_signature.emplace(line.substr(0, space), line.substr(space + 1));
+        }
+    }
+
+    /* Topological order guarantees that the fanins of a gate are decided first */
+    std::vector<bool> changed(circuit.Size(), false);
+    std::unordered_set<label_t> labels;
+    size_t to_build = 0;
+    for (gate_t gate : order) {
+        if (!IsBddGate(circuit, gate)) continue;
+
+        label_t label(circuit.Label(gate));
+        labels.insert(label);
+        bool is_changed = false;
+        for (gate_t fanin : circuit.Fanins(gate)) {
+            if (changed[fanin]) {
+                is_changed = true;
+                break;
+            }
+        }
+        if (!is_changed) {
+            auto previous = previous_signature.find(label);
+            is_changed = previous == previous_signature.end() ||
+                         previous->second != GateSignature(circuit, gate);
+        }
 
-ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
+        if (is_changed) {
+            changed[gate] = true;
+            label_to_bdd_id.erase(label);
+        }
+        if (!label_to_bdd_id.count(label)) {
+            to_build++;
+        }
+    }
 
-    auto bdd_id_it = node_to_bdd_id.find(circuit_node);
+    /* Gates removed from the circuit must not be saved with the next checkpoint */
+    for (auto it = label_to_bdd_id.begin(); it != label_to_bdd_id.end();) {
+        it = labels.count(it->first) ? std::next(it) : label_to_bdd_id.erase(it);
+    }
+    return to_build;
+}
+
+ClassProject::BDD_ID CircuitToBDD::findBddId(gate_t gate) {
 
-    if (bdd_id_it != node_to_bdd_id.end()) {
-        return bdd_id_it->second;
+    if (gate < gate_to_bdd_id.size()) {
+        return gate_to_bdd_id[gate];
     } else {
         throw std::runtime_error("Destination node ID is not part of the circuit graph!");
     }
@@ -84,26 +639,21 @@ ClassProject::BDD_ID CircuitToBDD::InputGate(const label_t &label) {
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
-    unique_ID_t node = *inputNodes.begin();
-    return bdd_manager->neg(findBddId(node));
+ClassProject::BDD_ID CircuitToBDD::NotGate(gate_range_t inputNodes) {
+    return bdd_manager->neg(findBddId(inputNodes[0]));
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::AndGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
+ClassProject::BDD_ID CircuitToBDD::AndGate(gate_range_t inputNodes) {
+    if (decomposition != decomposition_t::Linear) {
+        return Decompose(inputNodes, &ClassProject::ManagerInterface::and2, &ClassProject::ManagerInterface::and2);
+    }
 
     /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    ClassProject::BDD_ID first_op = findBddId(inputNodes[0]);
 
-        first_op = bdd_manager->and2(first_op, second_op);
+    for (size_t i = 1; i < inputNodes.size(); ++i) {
+        first_op = bdd_manager->and2(first_op, findBddId(inputNodes[i]));
     }
 
     /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
@@ -111,100 +661,188 @@ ClassProject::BDD_ID CircuitToBDD::AndGate(set_of_circuit_t inputNodes) {
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::OrGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
+ClassProject::BDD_ID CircuitToBDD::OrGate(gate_range_t inputNodes) {
+    if (decomposition != decomposition_t::Linear) {
+        return Decompose(inputNodes, &ClassProject::ManagerInterface::or2, &ClassProject::ManagerInterface::or2);
+    }
 
     /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    ClassProject::BDD_ID first_op = findBddId(inputNodes[0]);
 
-        first_op = bdd_manager->or2(first_op, second_op);
+    for (size_t i = 1; i < inputNodes.size(); ++i) {
+        first_op = bdd_manager->or2(first_op, findBddId(inputNodes[i]));
     }
 
     /* Return the ClassProject::BDD_ID equivalent to the OR of all inputs */
     return first_op;
 }
 
-ClassProject::BDD_ID CircuitToBDD::NandGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
+ClassProject::BDD_ID CircuitToBDD::NandGate(gate_range_t inputNodes) {
+    if (decomposition != decomposition_t::Linear) {
+        return Decompose(inputNodes, &ClassProject::ManagerInterface::and2, &ClassProject::ManagerInterface::nand2);
+    }
+
     ClassProject::BDD_ID first_op, second_op;
 
     /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        /* Create the NAND BDD node for the first two elements */
-        first_op = bdd_manager->nand2(first_op, second_op);
+    first_op = findBddId(inputNodes[0]);
+
+    gate_range_t other_inputs{inputNodes.begin() + 1, inputNodes.end()};
+    if (other_inputs.empty()) {
+        /* A single input, e.g. left over from duplicate inputs */
+        return bdd_manager->neg(first_op);
+    } else if (other_inputs.size() == 1) {
+        second_op = findBddId(other_inputs[0]);
     } else {
         /* AND of all inputs, to use as the second operator of the NAND gate */
-        second_op = AndGate(inputNodes);
-        /* Create the NAND BDD node */
-        first_op = bdd_manager->nand2(first_op, second_op);
+        second_op = AndGate(other_inputs);
     }
 
     /* Return the ClassProject::BDD_ID equivalent to the NAND of all inputs */
-    return first_op;
+    return bdd_manager->nand2(first_op, second_op);
 }
 
-ClassProject::BDD_ID CircuitToBDD::NorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
+ClassProject::BDD_ID CircuitToBDD::NorGate(gate_range_t inputNodes) {
+    if (decomposition != decomposition_t::Linear) {
+        return Decompose(inputNodes, &ClassProject::ManagerInterface::or2, &ClassProject::ManagerInterface::nor2);
+    }
+
     ClassProject::BDD_ID first_op, second_op;
 
     /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        /* Create the NOR BDD node for the first two elements */
-        first_op = bdd_manager->nor2(first_op, second_op);
+    first_op = findBddId(inputNodes[0]);
+
+    gate_range_t other_inputs{inputNodes.begin() + 1, inputNodes.end()};
+    if (other_inputs.empty()) {
+        /* A single input, e.g. left over from duplicate inputs */
+        return bdd_manager->neg(first_op);
+    } else if (other_inputs.size() == 1) {
+        second_op = findBddId(other_inputs[0]);
     } else {
-        /* OR of all inputs, to use as the second operator of the NAND gate */
-        second_op = OrGate(inputNodes);
-        /* Create the NOR BDD node */
-        first_op = bdd_manager->nor2(first_op, second_op);
+        /* OR of all inputs, to use as the second operator of the NOR gate */
+        second_op = OrGate(other_inputs);
     }
 
     /* Return the ClassProject::BDD_ID equivalent to the NOR of all inputs */
-    return first_op;
+    return bdd_manager->nor2(first_op, second_op);
 }
 
-ClassProject::BDD_ID CircuitToBDD::XorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
+ClassProject::BDD_ID CircuitToBDD::XorGate(gate_range_t inputNodes) {
+    if (decomposition != decomposition_t::Linear) {
+        return Decompose(inputNodes, &ClassProject::ManagerInterface::xor2, &ClassProject::ManagerInterface::xor2);
+    }
 
     /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    ClassProject::BDD_ID first_op = findBddId(inputNodes[0]);
 
-        first_op = bdd_manager->xor2(first_op, second_op);
+    for (size_t i = 1; i < inputNodes.size(); ++i) {
+        first_op = bdd_manager->xor2(first_op, findBddId(inputNodes[i]));
     }
 
     /* Return the ClassProject::BDD_ID equivalent to the XOR of all inputs */
     return first_op;
 }
 
+ClassProject::BDD_ID CircuitToBDD::Decompose(gate_range_t inputNodes, binary_operation_t operation,
+                                             binary_operation_t last_operation) {
+    ClassProject::ManagerInterface &manager = *bdd_manager;
+    std::vector<ClassProject::BDD_ID> operands;
+    operands.reserve(inputNodes.size());
+    for (gate_t input : inputNodes) {
+        operands.push_back(findBddId(input));
+    }
+
+    if (operands.size() == 1) {
+        /* nand2(f, f) is the negation of f; and2, or2 and xor2 pass a single input on */
+        return operation == last_operation ? operands[0] : (manager.*last_operation)(operands[0], operands[0]);
+    }
+
+    if (decomposition == decomposition_t::Balanced) {
+        /* Combine neighbours in rounds; an odd operand moves on to the next round */
+        while (operands.size() > 2) {
+            size_t combined = 0;
+            for (size_t i = 0; i + 1 < operands.size(); i += 2) {
+                operands[combined++] = (manager.*operation)(operands[i], operands[i + 1]);
+            }
+            if (operands.size() % 2) {
+                operands[combined++] = operands.back();
+            }
+            operands.resize(combined);
+        }
+        return (manager.*last_operation)(operands[0], operands[1]);
+    }
+
+    /* Greedy: the two operands with the fewest nodes first; the sequence number
+       breaks ties, so that the result does not depend on the heap layout */
+    typedef std::tuple<size_t, size_t, ClassProject::BDD_ID> operand_t;
+    std::priority_queue<operand_t, std::vector<operand_t>, std::greater<>> smallest;
+    size_t sequence = 0;
+    for (ClassProject::BDD_ID operand : operands) {
+        smallest.emplace(NodeCount(operand), sequence++, operand);
+    }
+    while (smallest.size() > 2) {
+        ClassProject::BDD_ID first = std::get<2>(smallest.top());
+        smallest.pop();
+        ClassProject::BDD_ID second = std::get<2>(smallest.top());
+        smallest.pop();
+        ClassProject::BDD_ID result = (manager.*operation)(first, second);
+        smallest.emplace(NodeCount(result), sequence++, result);
+    }
+    ClassProject::BDD_ID first = std::get<2>(smallest.top());
+    smallest.pop();
+    return (manager.*last_operation)(first, std::get<2>(smallest.top()));
+}
+
+size_t CircuitToBDD::NodeCount(ClassProject::BDD_ID root) {
+    visit_stamp.resize(bdd_manager->uniqueTableSize(), 0);
+    if (++visit_generation == 0) {
+        std::fill(visit_stamp.begin(), visit_stamp.end(), 0);
+        visit_generation = 1;
+    }
+
+    size_t count = 0;
+    visit_stack.assign(1, root);
+    while (!visit_stack.empty()) {
+        ClassProject::BDD_ID node = visit_stack.back();
+        visit_stack.pop_back();
+        if (visit_stamp[node] == visit_generation) {
+            continue;
+        }
+        visit_stamp[node] = visit_generation;
+        count++;
+        if (!bdd_manager->isConstant(node)) {
+            visit_stack.push_back(bdd_manager->coFactorTrue(node));
+            visit_stack.push_back(bdd_manager->coFactorFalse(node));
+        }
+    }
+    return count;
+}
+
+std::map<label_t, ClassProject::BDD_ID> CircuitToBDD::GetOutputBDDs(const std::set<label_t> &output_labels) {
+    std::map<label_t, ClassProject::BDD_ID> outputs;
+    for (const auto &output_label : output_labels) {
+        auto output_id_it = label_to_bdd_id.find(output_label);
+        if (output_id_it == label_to_bdd_id.end()) {
+            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+        }
+        outputs.emplace(output_label, output_id_it->second);
+    }
+    return outputs;
+}
+
+void CircuitToBDD::UseOutputBDDs(const std::map<label_t, ClassProject::BDD_ID> &outputs,
+                                 const std::string &benchmark_file) {
+    result_dir = ResultDir(benchmark_file);
+    if (!(std::filesystem::exists(result_dir)) && !std::filesystem::create_directory(result_dir)) {
+        throw std::runtime_error("Unable to create directory 'result' for the output!");
+    }
+    label_to_bdd_id.insert(outputs.begin(), outputs.end());
+}
+
+void CircuitToBDD::SetDumpThreads(unsigned threads) {
+    dump_threads = threads;
+}
+
 void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
 
     if ((!(std::filesystem::exists(result_dir + "/txt")) &
@@ -214,83 +852,162 @@ void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
         throw std::runtime_error("Unable to create directories 'txt' and 'dot' for the output!");
     }
 
+    std::vector<std::pair<label_t, ClassProject::BDD_ID>> work;
     for (const auto &output_label : output_labels) {
-
         auto output_id_it = label_to_bdd_id.find(output_label);
+        if (output_id_it == label_to_bdd_id.end()) {
+            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+        }
+        work.emplace_back(output_label, output_id_it->second);
+    }
 
-        if (output_id_it != label_to_bdd_id.end()) {
-
-            std::string dot_file_name = result_dir + "/dot/" + std::string(output_label) + ".dot";
-            std::string txt_file_name = result_dir + "/txt/" + std::string(output_label) + ".txt";
-
-            std::ofstream bdd_out_dot_file(dot_file_name);
-            std::ofstream bdd_out_txt_file(txt_file_name);
-
-            if (!bdd_out_dot_file.is_open() | !bdd_out_txt_file.is_open()) {
-                throw std::runtime_error("Unable to open Log File!");
+    /* The manager is only read while dumping, so the outputs are written by
+       several threads, each taking the next output until none is left */
+    unsigned threads = dump_threads != 0 ? dump_threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, work.size()));
+    std::atomic<size_t> next{0};
+    std::exception_ptr dump_error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        try {
+            for (size_t i = next++; i < work.size(); i = next++) {
+                DumpOutput(work[i].first, work[i].second);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!dump_error) {
+                dump_error = std::current_exception();
             }
+            next = work.size();
+        }
+    };
 
-            output_nodes.clear();
-            output_vars.clear();
-            bdd_manager->findNodes(output_id_it->second, output_nodes);
-            bdd_manager->findVars(output_id_it->second, output_vars);
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    if (dump_error) {
+        std::rethrow_exception(dump_error);
+    }
+}
 
-            dumpBddText(bdd_out_txt_file);
-            dumpBddDot(bdd_out_dot_file);
+void CircuitToBDD::DumpOutput(const label_t &label, ClassProject::BDD_ID root) {
+    /* One traversal collects every node with its top variable and cofactors */
+    std::vector<dump_node_t> nodes;
+    std::unordered_set<ClassProject::BDD_ID> visited;
+    std::vector<ClassProject::BDD_ID> stack{root};
+    while (!stack.empty()) {
+        ClassProject::BDD_ID node = stack.back();
+        stack.pop_back();
+        if (!visited.insert(node).second) {
+            continue;
+        }
+        if (bdd_manager->isConstant(node)) {
+            nodes.push_back({node, node, node, node, NO_LEVEL});
+        } else {
+            nodes.push_back({node, bdd_manager->topVar(node), bdd_manager->coFactorFalse(node),
+                             bdd_manager->coFactorTrue(node), 0});
+            stack.push_back(nodes.back().high);
+            stack.push_back(nodes.back().low);
+        }
+    }
+    std::sort(nodes.begin(), nodes.end(),
+              [](const dump_node_t &a, const dump_node_t &b) { return a.id < b.id; });
+
+    /* Bucket the inner nodes by top variable; within a level they stay in ID order */
+    std::vector<uint32_t> by_level;
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].level != NO_LEVEL) {
+            by_level.push_back(i);
+        }
+    }
+    std::stable_sort(by_level.begin(), by_level.end(),
+                     [&](uint32_t a, uint32_t b) { return nodes[a].top_var < nodes[b].top_var; });
+    std::vector<dump_level_t> levels;
+    for (uint32_t i : by_level) {
+        if (levels.empty() || levels.back().var != nodes[i].top_var) {
+            levels.push_back({nodes[i].top_var, bdd_manager->getTopVarName(nodes[i].top_var), {}});
+        }
+        nodes[i].level = static_cast<uint32_t>(levels.size() - 1);
+        levels.back().nodes.push_back(nodes[i].id);
+    }
 
-            bdd_out_dot_file.close();
-            bdd_out_txt_file.close();
+    /* Both files are formatted in memory and written with a single call */
+    std::string buffer;
+    dumpBddText(buffer, nodes, levels);
+    WriteWholeFile(result_dir + "/txt/" + std::string(label) + ".txt", buffer);
+    buffer.clear();
+    dumpBddDot(buffer, nodes, levels);
+    WriteWholeFile(result_dir + "/dot/" + std::string(label) + ".dot", buffer);
+}
 
+void CircuitToBDD::dumpBddText(std::string &out, const std::vector<dump_node_t> &nodes,
+                               const std::vector<dump_level_t> &levels) {
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+        if (it->level == NO_LEVEL) {
+            out += "Terminal Node: ";
+            AppendNumber(out, it->id);
+            out += '\n';
         } else {
-            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+            out += "Variable Node: ";
+            AppendNumber(out, it->id);
+            out += " Top Var Id: ";
+            AppendNumber(out, it->top_var);
+            out += " Top Var Name: ";
+            out += levels[it->level].name;
+            out += " Low: ";
+            AppendNumber(out, it->low);
+            out += " High: ";
+            AppendNumber(out, it->high);
+            out += '\n';
         }
     }
 }
 
-void CircuitToBDD::dumpBddText(std::ostream &out) {
-    for (auto it = output_nodes.rbegin(); it != output_nodes.rend(); ++it) {
-        if (bdd_manager->isConstant(*it)) {
-            out << "Terminal Node: " << (*it) << "\n";
-        } else {
-            out << "Variable Node: " << (*it)
-                << " Top Var Id: " << bdd_manager->topVar(*it)
-                << " Top Var Name: " << bdd_manager->getTopVarName(bdd_manager->topVar(*it))
-                << " Low: " << bdd_manager->coFactorFalse(*it)
-                << " High: " << bdd_manager->coFactorTrue(*it) << "\n";
-        }
-    }
-}
-
-void CircuitToBDD::dumpBddDot(std::ostream &out) {
-    out << "digraph BDD {\n";
-    out << "center = true;\n";
-    out << "{ rank = same; { node [style=invis]; \"T\" };\n";
-    out << " { node [shape=box,fontsize=12]; \"0\"; }\n";
-    out << "  { node [shape=box,fontsize=12]; \"1\"; }\n}\n";
-    for (const auto var : output_vars) {
-        out << R"({ rank=same; { node [shape=plaintext,fontname="Times Italic",fontsize=12] ")"
-            << bdd_manager->getTopVarName(var) << "\" };";
-        for (unsigned long node : output_nodes) {
-            if (bdd_manager->topVar(node) == var) {
-                out << "\"" << node << "\";";
-            }
+void CircuitToBDD::dumpBddDot(std::string &out, const std::vector<dump_node_t> &nodes,
+                              const std::vector<dump_level_t> &levels) {
+    out += "digraph BDD {\n";
+    out += "center = true;\n";
+    out += "{ rank = same; { node [style=invis]; \"T\" };\n";
+    out += " { node [shape=box,fontsize=12]; \"0\"; }\n";
+    out += "  { node [shape=box,fontsize=12]; \"1\"; }\n}\n";
+    for (const auto &level : levels) {
+        out += R"({ rank=same; { node [shape=plaintext,fontname="Times Italic",fontsize=12] ")";
+        out += level.name;
+        out += "\" };";
+        for (ClassProject::BDD_ID node : level.nodes) {
+            out += '"';
+            AppendNumber(out, node);
+            out += "\";";
         }
-        out << "}\n";
+        out += "}\n";
     }
-    out << "edge [style = invis]; {";
-    for (const auto var : output_vars) {
-        out << "\"" << bdd_manager->getTopVarName(var) << "\" -> ";
+    out += "edge [style = invis]; {";
+    for (const auto &level : levels) {
+        out += '"';
+        out += level.name;
+        out += "\" -> ";
     }
-    out << "\"T\"; }\n";
-    for (const auto node : output_nodes) {
-        if (!bdd_manager->isConstant(node)) {
-            out << "\"" << node << "\" -> \"" << bdd_manager->coFactorTrue(node)
-                << "\" [style=solid,arrowsize=\".75\"];\n";
-            out << "\"" << node << "\" -> \"" << bdd_manager->coFactorFalse(node)
-                << "\" [style=dashed,arrowsize=\".75\"];\n";
+    out += "\"T\"; }\n";
+    for (const auto &node : nodes) {
+        if (node.level != NO_LEVEL) {
+            out += '"';
+            AppendNumber(out, node.id);
+            out += "\" -> \"";
+            AppendNumber(out, node.high);
+            out += "\" [style=solid,arrowsize=\".75\"];\n";
+            out += '"';
+            AppendNumber(out, node.id);
+            out += "\" -> \"";
+            AppendNumber(out, node.low);
+            out += "\" [style=dashed,arrowsize=\".75\"];\n";
         }
     }
-    out << "}\n";
+    out += "}\n";
 }
 
 
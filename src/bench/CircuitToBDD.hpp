@@ -10,6 +10,38 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <functional>
+#include <chrono>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+
+/**
+ * \brief How gates with more than two inputs are split into binary operations
+ *
+ *  Linear folds the inputs from left to right; NAND and NOR combine the first
+ *   input with the AND or OR of the others. Balanced combines the inputs
+ *   pairwise in rounds, like a binary tree. Greedy always combines the two
+ *   operands with the fewest BDD nodes, so that large intermediate results
+ *   are built as late as possible.
+ */
+enum class decomposition_t {
+    Linear, Balanced, Greedy
+};
+
+/**
+ * \brief Returns the name of a decomposition strategy, e.g. "balanced"
+ */
+const char *DecompositionName(decomposition_t decomposition);
+
+/**
+ * \brief Looks up a decomposition strategy by name
+ * \param name "linear", "balanced" or "greedy"
+ * \param decomposition receives the strategy if the name is known
+ * \return true if the name is known
+ */
+bool ParseDecomposition(const std::string &name, decomposition_t &decomposition);
 
 
 /**
@@ -17,7 +49,7 @@
  * 
  * \brief Class to convert circuits nodes into BDD nodes
  *
- *  Circuit nodes are generated by the class bench_circuit_manager.
+ *  Circuits are generated by the class BenchParser.
  *
  * \authors {Carolina Nogueira, Lucas Deutschmann}
  * 
@@ -30,42 +62,212 @@ public:
     ~CircuitToBDD();
 
     /**
-     * \brief Generates a BDD from the circuit nodes provided
-     * \param Topologically sorted list containing the circuit nodes
+     * \brief Generates a BDD from the circuit provided
+     * \param circuit the gates of the circuit
+     * \param order the gates of circuit in topological order
      * \return none
      *
      *  Generates the calls to the BDD package in order to
      *   generate the BDD equivalent to the provided circuit.
      */
-    void GenerateBDD(const std::list<circuit_node_t> &circuit, const std::string& benchmark_file);
+    void GenerateBDD(const Circuit &circuit, const std::vector<gate_t> &order, const std::string& benchmark_file);
+
+    /**
+     * \brief Parses a bench file and generates the BDDs while it is being read
+     * \param benchmark_file the path to the benchmark file
+     * \return the labels of the outputs, like BenchParser::GetListOfOutputLabels
+     *
+     *  A parser thread hands batches of statements to the calling thread
+     *   through a bounded queue. A gate is built as soon as all of its fanins
+     *   are; a gate read before one of its fanins waits in a pending list. On
+     *   netlists written mostly in topological order the BDDs are thus built
+     *   while the rest of the file is read, and no Circuit is held in memory.
+     *
+     *  Unlike GenerateBDD, variables are created in the order gates first read
+     *   them, the fanins of a gate are combined in the order their labels first
+     *   appear in the file, and gates no output depends on are built as well
+     *   (and must be well defined). The output functions are the same, but the
+     *   variable order, BDD IDs and node counts may differ. As in
+     *   CircuitBuilder, if a label is defined twice the first definition
+     *   counts and later ones are ignored without an error.
+     */
+    std::set<label_t> StreamBDD(const std::string &benchmark_file);
+
+    /**
+     * \brief Returns the directory the results of a benchmark file are written to
+     * \param benchmark_file the path to the benchmark file
+     * \return std::string
+     */
+    static std::string ResultDir(const std::string &benchmark_file);
+
+    /**
+     * \brief Writes the BDD ID of every gate built so far, for RestoreGateMap
+     * \param csv_file the file to write, in the format of BNode_BDD.csv
+     *
+     *  The file is written under a temporary name and renamed, so a crash
+     *   leaves either the previous gate map or the new one, never a partial one.
+     */
+    void SaveGateMap(const std::string &csv_file) const;
+
+    /**
+     * \brief Reuses the gate BDDs listed in a gate map of a previous run
+     * \param csv_file the gate map written by SaveGateMap
+     * \param node_count number of nodes of the restored manager
+     * \return number of gates that will be skipped by GenerateBDD
+     *
+     *  Must be called after the manager was restored from the checkpoint that
+     *   belongs to the gate map. Entries referring to nodes beyond node_count
+     *   were built after the checkpoint was taken and are ignored. This filter
+     *   cannot tell a reused ID from a valid one, which is why the manager must
+     *   not have collected garbage (see SetEarlyRelease).
+     */
+    size_t RestoreGateMap(const std::string &csv_file, size_t node_count);
+
+    /**
+     * \brief Calls hook periodically while GenerateBDD is running
+     * \param hook function that writes a checkpoint of the manager
+     * \param interval minimum time between two calls
+     *
+     *  The hook runs between two gates, so a checkpoint of the manager and a
+     *   gate map saved by the hook describe the same state. BNode_BDD.csv is
+     *   flushed right before each call.
+     */
+    void SetCheckpointHook(std::function<void()> hook, std::chrono::seconds interval);
+
+    /**
+     * \brief Selects how gates with more than two inputs are built
+     * \param strategy the decomposition strategy, Linear by default
+     *
+     *  All strategies yield the same functions; the BDD IDs and the number
+     *   of nodes created on the way differ.
+     */
+    void SetDecomposition(decomposition_t strategy);
+
+    /**
+     * \brief Releases the BDD of a gate as soon as all of its fanouts are built
+     * \param enable true to release gates during GenerateBDD
+     *
+     *  GenerateBDD then counts the unbuilt fanouts of every gate, forgets the
+     *   BDD of a gate whose last fanout is built and, whenever the live nodes
+     *   of the manager doubled, lets the manager free the nodes no unreleased
+     *   gate refers to. Only the BDDs of the outputs and flip flops remain.
+     *   BNode_BDD.csv still lists every gate, but the IDs of released gates
+     *   may have been reused. Cannot be combined with RestoreGateMap.
+     */
+    void SetEarlyRelease(bool enable);
+
+    /**
+     * \brief Sets the number of threads PrintBDD writes the outputs with
+     * \param threads the number of threads, 0 for one per hardware thread (the default)
+     */
+    void SetDumpThreads(unsigned threads);
+
+    /**
+     * \brief Writes the signature (type and fanin labels) of every gate of the circuit
+     * \param circuit the gates of the circuit
+     * \param order the gates of circuit in topological order
+     * \param signature_file the file to write to
+     */
+    static void SaveCircuitSignature(const Circuit &circuit, const std::vector<gate_t> &order,
+                                     const std::string &signature_file);
+
+    /**
+     * \brief Drops the restored BDDs of gates whose cone changed since the previous run
+     * \param circuit the gates of the circuit
+     * \param order the gates of circuit in topological order
+     * \param signature_file the signature written by SaveCircuitSignature in the previous run
+     * \return number of gates GenerateBDD has to build
+     *
+     *  A gate is rebuilt if its type or fanin labels differ from the previous
+     *   signature, or if one of its fanins is rebuilt. All other gates keep the
+     *   BDDs restored by RestoreGateMap; restored gates that are no longer part
+     *   of the circuit are forgotten.
+     */
+    size_t InvalidateChangedGates(const Circuit &circuit, const std::vector<gate_t> &order,
+                                  const std::string &signature_file);
 
 
     /**
      * \brief Print the generated BDD in text and dot format
      * \param The set of output labels to print a BDD for
      * \return none
+     *
+     *  The outputs are divided among the threads set by SetDumpThreads. Each
+     *   file is formatted in memory and written with a single write call.
      */
     void PrintBDD(const std::set<label_t> &output_labels);
 
+    /**
+     * \brief Builds the BDD of a gate and of the gates in its cone that are not built yet
+     * \param circuit the gates of the circuit, the same in every call
+     * \param gate the gate to build, neither an output nor a flip flop
+     * \return the BDD ID of the gate
+     *
+     *  Inputs become variables of the same label, so two circuits built into
+     *   one manager, each by its own CircuitToBDD, share their variables.
+     *   Unlike GenerateBDD, nothing is written to the result directory.
+     */
+    ClassProject::BDD_ID BuildCone(const Circuit &circuit, gate_t gate);
+
+    /**
+     * \brief Returns the BDD IDs of the given output labels
+     * \param output_labels the labels of the outputs
+     * \return std::map<label_t, ClassProject::BDD_ID>
+     */
+    std::map<label_t, ClassProject::BDD_ID> GetOutputBDDs(const std::set<label_t> &output_labels);
+
+    /**
+     * \brief Uses already built output BDDs instead of calling GenerateBDD
+     * \param outputs the output labels and their BDD IDs
+     * \param benchmark_file the path to the benchmark file the BDDs belong to
+     *
+     *  Prepares the result directory so that PrintBDD can be called next.
+     */
+    void UseOutputBDDs(const std::map<label_t, ClassProject::BDD_ID> &outputs, const std::string &benchmark_file);
+
 private:
 
-    std::unordered_map<unique_ID_t, ClassProject::BDD_ID> node_to_bdd_id; ///< Mapping from circuit node's unique ID to its BDD ID
+    std::vector<ClassProject::BDD_ID> gate_to_bdd_id; ///< BDD ID of each gate of the circuit, indexed by gate (by symbol in StreamBDD)
     std::unordered_map<label_t, ClassProject::BDD_ID> label_to_bdd_id; ///< Mapping from node's label to its BDD ID
 
     shared_ptr<ClassProject::ManagerInterface> bdd_manager{};
     std::string result_dir; ///< Directory where the results are stored
 
-    std::set<ClassProject::BDD_ID> output_nodes;
-    std::set<ClassProject::BDD_ID> output_vars;
+    std::function<void()> checkpoint_hook;   ///< Called periodically during GenerateBDD
+    std::chrono::seconds checkpoint_interval{0};
+
+    decomposition_t decomposition = decomposition_t::Linear;
+    bool early_release = false;
+    std::vector<uint32_t> visit_stamp; ///< Per node, the NodeCount call that visited it last
+    uint32_t visit_generation = 0;
+    std::vector<ClassProject::BDD_ID> visit_stack;
+    std::vector<bool> cone_built; ///< Per gate, whether BuildCone built it
+
+    unsigned dump_threads = 0;
+
 
+    /**
+     * \brief Creates the result directory and opens BNode_BDD.csv in it
+     * \param benchmark_file the path to the benchmark file
+     * \return std::ofstream with the header of the csv file written
+     */
+    std::ofstream OpenGateLog(const std::string &benchmark_file);
 
     /**
-     * \brief Returns the BDD_ID of the given circuit ID
-     * \param circuit_node is unique_ID_t
+     * \brief Returns the BDD_ID of the given gate
+     * \param gate is gate_t
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID findBddId(unique_ID_t circuit_node);
+    ClassProject::BDD_ID findBddId(gate_t gate);
+
+    /**
+     * \brief Builds one gate from the BDDs of its fanins
+     * \param circuit the gates of the circuit
+     * \param gate the gate to build, neither an output nor a flip flop
+     * \return ClassProject::BDD_ID
+     */
+    ClassProject::BDD_ID BuildGate(const Circuit &circuit, gate_t gate);
 
     /**
      * \brief Generates the BDD node equivalent to a variable with label "label".
@@ -77,53 +279,95 @@ private:
 
     /**
      * \brief Generates the BDD node equivalent to the NOT gate.
-     * \param node is set_of_circuit_t containing the circuit ID of the gate to be inverted.
+     * \param inputNodes is gate_range_t containing the gate to be inverted.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NotGate(const set_of_circuit_t &node);
+    ClassProject::BDD_ID NotGate(gate_range_t inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the AND gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param inputNodes is gate_range_t containing the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID AndGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID AndGate(gate_range_t inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the OR gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param inputNodes is gate_range_t containing the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID OrGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID OrGate(gate_range_t inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NAND gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param inputNodes is gate_range_t containing the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NandGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID NandGate(gate_range_t inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NOR gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param inputNodes is gate_range_t containing the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID NorGate(gate_range_t inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the XOR gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param inputNodes is gate_range_t containing the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID XorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID XorGate(gate_range_t inputNodes);
+
+    typedef ClassProject::BDD_ID (ClassProject::ManagerInterface::*binary_operation_t)(ClassProject::BDD_ID,
+                                                                                       ClassProject::BDD_ID);
+
+    /**
+     * \brief Combines the inputs of a gate with the Balanced or Greedy strategy
+     * \param inputNodes the gates to be used as input
+     * \param operation the associative operation combining two operands
+     * \param last_operation the operation producing the result from the last two
+     *        operands, e.g. nand2 for a NAND gate with operation and2
+     * \return ClassProject::BDD_ID
+     */
+    ClassProject::BDD_ID Decompose(gate_range_t inputNodes, binary_operation_t operation,
+                                   binary_operation_t last_operation);
+
+    /**
+     * \brief Returns the number of nodes of a BDD, terminals included
+     */
+    size_t NodeCount(ClassProject::BDD_ID root);
+
+    /** A node of a dumped BDD, with the index of its level or NO_LEVEL for a terminal */
+    struct dump_node_t {
+        ClassProject::BDD_ID id, top_var, low, high;
+        uint32_t level;
+    };
+
+    /** The nodes of a dumped BDD labelled with one variable, in ID order */
+    struct dump_level_t {
+        ClassProject::BDD_ID var;
+        std::string name;
+        std::vector<ClassProject::BDD_ID> nodes;
+    };
+
+    static constexpr uint32_t NO_LEVEL = UINT32_MAX;
+
+    /**
+     * \brief Writes the txt and dot file of one output
+     *
+     *  The BDD is traversed once; its nodes, sorted by ID, and their levels,
+     *   sorted by variable, feed both dumps.
+     */
+    void DumpOutput(const label_t &label, ClassProject::BDD_ID root);
 
-    void dumpBddText(std::ostream &out);
+    void dumpBddText(std::string &out, const std::vector<dump_node_t> &nodes, const std::vector<dump_level_t> &levels);
 
-    void dumpBddDot(std::ostream &out);
+    void dumpBddDot(std::string &out, const std::vector<dump_node_t> &nodes, const std::vector<dump_level_t> &levels);
 };   
@@ -0,0 +1,227 @@
+//
+// Content-addressed cache of the output BDDs built by VDSProject_bench
+//
+
+#include "ResultCache.hpp"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+/* Bump whenever a change of the library alters the BDDs written to the cache */
+#define RESULT_CACHE_VERSION "2"
+
+namespace {
+    /* SHA-256 as specified in FIPS 180-4 */
+    class Sha256 {
+    public:
+        void Update(const char *data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                block[fill++] = static_cast<uint8_t>(data[i]);
+                if (fill == block.size()) {
+                    Compress();
+                    fill = 0;
+                }
+            }
+            length += size;
+        }
+
+        std::string HexDigest() {
+            uint64_t bits = length * 8;
+            const char pad = static_cast<char>(0x80), zero = 0;
+            Update(&pad, 1);
+            while (fill != 56) {
+                Update(&zero, 1);
+            }
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                char byte = static_cast<char>(bits >> shift);
+                Update(&byte, 1);
+            }
+
+            char hex[65];
+            for (size_t i = 0; i < state.size(); ++i) {
+                std::snprintf(hex + 8 * i, 9, "%08x", state[i]);
+            }
+            return hex;
+        }
+
+    private:
+        std::array<uint32_t, 8> state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        std::array<uint8_t, 64> block{};
+        size_t fill = 0;
+        uint64_t length = 0;
+
+        static uint32_t Rotate(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+        void Compress() {
+            static const uint32_t k[64] = {
+                    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+            uint32_t w[64];
+            for (int i = 0; i < 16; ++i) {
+                w[i] = static_cast<uint32_t>(block[4 * i]) << 24 | static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+                       static_cast<uint32_t>(block[4 * i + 2]) << 8 | static_cast<uint32_t>(block[4 * i + 3]);
+            }
+            for (int i = 16; i < 64; ++i) {
+                uint32_t s0 = Rotate(w[i - 15], 7) ^ Rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = Rotate(w[i - 2], 17) ^ Rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; ++i) {
+                uint32_t t1 = h + (Rotate(e, 6) ^ Rotate(e, 11) ^ Rotate(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                uint32_t t2 = (Rotate(a, 2) ^ Rotate(a, 13) ^ Rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+    };
+
+    /* Hashes the remaining contents of a stream, returns the number of bytes read */
+    uint64_t HashStream(std::istream &in, Sha256 &hash) {
+        std::vector<char> buffer(1 << 20);
+        uint64_t size = 0;
+        while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0) {
+            hash.Update(buffer.data(), static_cast<size_t>(in.gcount()));
+            size += static_cast<uint64_t>(in.gcount());
+        }
+        return size;
+    }
+
+    std::string FileDigest(const std::string &file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open()) {
+            return "";
+        }
+        Sha256 hash;
+        HashStream(in, hash);
+        return hash.HexDigest();
+    }
+}
+
+ResultCache::ResultCache(std::string cache_dir) : cache_dir(std::move(cache_dir)) {}
+
+cache_key_t ResultCache::Key(const std::string &benchmark_file, const std::string &build_options) {
+    std::ifstream in(benchmark_file, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("ResultCache::Key: could not open file: " + benchmark_file);
+    }
+
+    std::string prefix = RESULT_CACHE_VERSION "|" + build_options + "|";
+    Sha256 hash;
+    hash.Update(prefix.data(), prefix.size());
+
+    cache_key_t key;
+    key.input_size = HashStream(in, hash);
+    key.digest = hash.HexDigest();
+    key.name = key.digest.substr(0, 16);
+    return key;
+}
+
+bool ResultCache::Lookup(const cache_key_t &key, ClassProject::Manager &manager,
+                         std::map<std::string, ClassProject::BDD_ID> &outputs) const {
+    std::string entry = EntryPath(key);
+    std::ifstream meta(entry + ".meta");
+    if (!meta.is_open()) {
+        return false;
+    }
+
+    /* The entry must have been stored for exactly these inputs, and its checkpoint must be intact */
+    std::string magic, version, digest, checkpoint_digest;
+    uint64_t input_size = 0;
+    size_t count = 0;
+    if (!(meta >> magic >> version >> input_size >> digest >> checkpoint_digest >> count) || magic != "VDSCACHE" ||
+        version != RESULT_CACHE_VERSION || input_size != key.input_size || digest != key.digest ||
+        checkpoint_digest != FileDigest(entry + ".ckpt")) {
+        return false;
+    }
+
+    std::map<std::string, ClassProject::BDD_ID> entry_outputs;
+    ClassProject::BDD_ID id;
+    std::string label;
+    for (size_t i = 0; i < count; ++i) {
+        if (!(meta >> id >> label)) {
+            return false;
+        }
+        entry_outputs[label] = id;
+    }
+
+    ClassProject::Manager restored;
+    try {
+        restored.restore(entry + ".ckpt");
+    } catch (const std::runtime_error &) {
+        return false;
+    }
+    for (const auto &output : entry_outputs) {
+        if (output.second >= restored.uniqueTableSize()) {
+            return false;
+        }
+    }
+
+    manager = std::move(restored);
+    outputs = std::move(entry_outputs);
+    return true;
+}
+
+void ResultCache::Store(const cache_key_t &key, ClassProject::Manager &manager,
+                        const std::map<std::string, ClassProject::BDD_ID> &outputs) const {
+    if (!std::filesystem::exists(cache_dir) && !std::filesystem::create_directories(cache_dir)) {
+        throw std::runtime_error("Unable to create cache directory " + cache_dir);
+    }
+
+    /* Concurrent runs must never observe a partially written file; a run that
+       sees the new checkpoint with an old meta file rejects it by its digest */
+    std::string entry = EntryPath(key);
+    std::string suffix = ".tmp" + std::to_string(::getpid());
+    manager.checkpoint(entry + ".ckpt" + suffix);
+
+    std::ostringstream meta;
+    meta << "VDSCACHE " RESULT_CACHE_VERSION "\n" << key.input_size << "\n" << key.digest << "\n"
+         << FileDigest(entry + ".ckpt" + suffix) << "\n" << outputs.size() << "\n";
+    for (const auto &output : outputs) {
+        meta << output.second << " " << output.first << "\n";
+    }
+    std::ofstream out(entry + ".meta" + suffix);
+    out << meta.str();
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Unable to write cache entry " + entry + ".meta");
+    }
+
+    std::filesystem::rename(entry + ".ckpt" + suffix, entry + ".ckpt");
+    std::filesystem::rename(entry + ".meta" + suffix, entry + ".meta");
+}
+
+std::string ResultCache::EntryPath(const cache_key_t &key) const {
+    return cache_dir + "/" + key.name;
+}
@@ -0,0 +1,73 @@
+//
+// Content-addressed cache of the output BDDs built by VDSProject_bench
+//
+
+#pragma once
+
+#include "../Manager.h"
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * \brief Identifies the inputs of a benchmark run
+ */
+struct cache_key_t {
+    std::string name;        ///< Hexadecimal prefix of digest, names the entry files
+    uint64_t input_size = 0; ///< Size of the benchmark file in bytes
+    std::string digest;      ///< Hexadecimal SHA-256 of the cache version, the build options and the file
+};
+
+/**
+ * \class ResultCache
+ *
+ * \brief Stores the output BDDs of a benchmark run under a hash of its inputs.
+ *
+ *  The key covers the contents of the benchmark file and a string describing
+ *   every build option that influences the result. An entry is a checkpoint
+ *   of the manager, see ClassProject::Manager::checkpoint, and a small text
+ *   file holding the input size and digest of the key, the SHA-256 of the
+ *   checkpoint and the output labels with their BDD IDs. A hit restores the
+ *   checkpoint, so every node keeps the ID it had in the run that stored the
+ *   entry and the dumps are the same as those of a fresh build.
+ *
+ */
+class ResultCache {
+
+public:
+
+    explicit ResultCache(std::string cache_dir);
+
+    /**
+     * \brief Computes the cache key of a benchmark file and its build options
+     * \param benchmark_file the path to the benchmark file
+     * \param build_options description of the options the result depends on
+     * \return cache_key_t the key of the entry for these inputs
+     */
+    static cache_key_t Key(const std::string &benchmark_file, const std::string &build_options);
+
+    /**
+     * \brief Restores the manager an entry was stored from
+     * \param key as returned by Key
+     * \param manager the manager whose state is replaced on a hit
+     * \param outputs receives the output labels and their BDD IDs
+     * \return true on a hit, false if there is no usable entry for key
+     *
+     *  An entry that is incomplete, corrupt or was stored for other inputs
+     *   under the same name is a miss; the manager is then left unchanged.
+     */
+    bool Lookup(const cache_key_t &key, ClassProject::Manager &manager,
+                std::map<std::string, ClassProject::BDD_ID> &outputs) const;
+
+    /**
+     * \brief Stores the manager and its output BDDs under key, replacing an existing entry atomically
+     */
+    void Store(const cache_key_t &key, ClassProject::Manager &manager,
+               const std::map<std::string, ClassProject::BDD_ID> &outputs) const;
+
+private:
+
+    std::string cache_dir; ///< Directory holding two files per entry
+
+    std::string EntryPath(const cache_key_t &key) const;
+};
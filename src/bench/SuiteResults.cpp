@@ -0,0 +1,275 @@
+//
+// Results of VDSProject_suite and their comparison against a baseline
+//
+
+#include "SuiteResults.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+namespace {
+    std::string JsonString(const std::string &text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    void WriteStage(std::ostream &out, const char *name, const stage_time_t &time) {
+        out << JsonString(name) << ": {\"wall\": " << time.wall << ", \"cpu\": " << time.cpu << "}";
+    }
+
+    stage_time_t ReadStage(const boost::property_tree::ptree &run, const char *name) {
+        return {run.get<double>(std::string(name) + ".wall"), run.get<double>(std::string(name) + ".cpu")};
+    }
+
+    run_status_t ParseStatus(const std::string &name) {
+        for (run_status_t status : {run_status_t::Ok, run_status_t::Failed, run_status_t::Timeout}) {
+            if (name == RunStatusName(status)) {
+                return status;
+            }
+        }
+        throw std::runtime_error("unknown run status '" + name + "'");
+    }
+
+    double Median(std::vector<double> values) {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+
+    /* The median absolute deviation, scaled to estimate the standard deviation of normal samples */
+    double Spread(const std::vector<double> &values) {
+        double median = Median(values);
+        std::vector<double> deviations;
+        for (double value : values) {
+            deviations.push_back(std::fabs(value - median));
+        }
+        return 1.4826 * Median(deviations);
+    }
+
+    std::string Format(double value) {
+        std::ostringstream text;
+        text << std::setprecision(4) << value;
+        return text.str();
+    }
+
+    /* The runs of a circuit that finished, or nullptr if any did not */
+    const circuit_runs_t *FindComplete(const suite_results_t &results, const std::string &name) {
+        for (const auto &circuit : results.circuits) {
+            if (circuit.name == name) {
+                bool complete = circuit.runs.size() == results.repetitions &&
+                                std::all_of(circuit.runs.begin(), circuit.runs.end(), [](const run_record_t &run) {
+                                    return run.status == run_status_t::Ok;
+                                });
+                return complete ? &circuit : nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    double HitRate(const run_record_t &run) {
+        return run.cache.computedLookups == 0 ? 0.0 : static_cast<double>(run.cache.computedHits) /
+                                                      static_cast<double>(run.cache.computedLookups);
+    }
+}
+
+const char *RunStatusName(run_status_t status) {
+    switch (status) {
+        case run_status_t::Ok:
+            return "ok";
+        case run_status_t::Timeout:
+            return "timeout";
+        default:
+            return "failed";
+    }
+}
+
+void WriteSuiteJson(const std::string &json_file, const suite_results_t &results) {
+    std::ofstream out(json_file);
+    if (!out.is_open()) {
+        throw std::runtime_error("Unable to open " + json_file);
+    }
+    out << std::setprecision(9);
+    out << "{\n  \"format\": 1,\n  \"repetitions\": " << results.repetitions << ",\n  \"decomposition\": "
+        << JsonString(DecompositionName(results.decomposition)) << ",\n  \"circuits\": [";
+    for (size_t c = 0; c < results.circuits.size(); ++c) {
+        const circuit_runs_t &circuit = results.circuits[c];
+        out << (c ? "," : "") << "\n    {\"name\": " << JsonString(circuit.name) << ", \"file\": "
+            << JsonString(circuit.file) << ", \"runs\": [";
+        for (size_t r = 0; r < circuit.runs.size(); ++r) {
+            const run_record_t &run = circuit.runs[r];
+            out << (r ? "," : "") << "\n      {\"status\": " << JsonString(RunStatusName(run.status)) << ", ";
+            WriteStage(out, "parse", run.parse);
+            out << ", ";
+            WriteStage(out, "sort", run.sort);
+            out << ", ";
+            WriteStage(out, "build", run.build);
+            out << ", ";
+            WriteStage(out, "dump", run.dump);
+            out << ",\n       \"peak_rss_kb\": " << run.peak_rss_kb << ", \"gates\": " << run.gates
+                << ", \"nodes\": " << run.nodes << ", \"peak_live_nodes\": " << run.peak_live_nodes
+                << ", \"output_nodes\": " << run.output_nodes
+                << ",\n       \"computed_table\": {\"lookups\": " << run.cache.computedLookups
+                << ", \"hits\": " << run.cache.computedHits << "}, \"unique_table\": {\"lookups\": "
+                << run.cache.uniqueLookups << ", \"hits\": " << run.cache.uniqueHits << "}}";
+        }
+        out << "\n    ]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void WriteSuiteCsv(const std::string &csv_file, const suite_results_t &results) {
+    std::ofstream out(csv_file);
+    if (!out.is_open()) {
+        throw std::runtime_error("Unable to open " + csv_file);
+    }
+    out << std::setprecision(9);
+    out << "circuit,repetition,status,parse_wall,parse_cpu,sort_wall,sort_cpu,build_wall,build_cpu,"
+           "dump_wall,dump_cpu,peak_rss_kb,gates,nodes,peak_live_nodes,output_nodes,"
+           "computed_lookups,computed_hits,unique_lookups,unique_hits\n";
+    for (const auto &circuit : results.circuits) {
+        for (size_t r = 0; r < circuit.runs.size(); ++r) {
+            const run_record_t &run = circuit.runs[r];
+            out << circuit.name << "," << r << "," << RunStatusName(run.status) << "," << run.parse.wall << ","
+                << run.parse.cpu << "," << run.sort.wall << "," << run.sort.cpu << "," << run.build.wall << ","
+                << run.build.cpu << "," << run.dump.wall << "," << run.dump.cpu << "," << run.peak_rss_kb << ","
+                << run.gates << "," << run.nodes << "," << run.peak_live_nodes << "," << run.output_nodes << ","
+                << run.cache.computedLookups << "," << run.cache.computedHits << ","
+                << run.cache.uniqueLookups << "," << run.cache.uniqueHits << "\n";
+        }
+    }
+}
+
+suite_results_t ReadSuiteJson(const std::string &json_file) {
+    boost::property_tree::ptree tree;
+    try {
+        boost::property_tree::read_json(json_file, tree);
+    } catch (const boost::property_tree::json_parser_error &error) {
+        throw std::runtime_error(error.what());
+    }
+
+    suite_results_t results;
+    try {
+        results.repetitions = tree.get<unsigned>("repetitions");
+        std::string decomposition = tree.get<std::string>("decomposition");
+        if (!ParseDecomposition(decomposition, results.decomposition)) {
+            throw std::runtime_error("unknown decomposition '" + decomposition + "'");
+        }
+        /* JSON arrays are children with empty keys */
+        for (const auto &circuit_entry : tree.get_child("circuits")) {
+            const boost::property_tree::ptree &circuit_tree = circuit_entry.second;
+            circuit_runs_t circuit{circuit_tree.get<std::string>("name"), circuit_tree.get<std::string>("file"), {}};
+            for (const auto &run_entry : circuit_tree.get_child("runs")) {
+                const boost::property_tree::ptree &run_tree = run_entry.second;
+                run_record_t run;
+                run.status = ParseStatus(run_tree.get<std::string>("status"));
+                run.parse = ReadStage(run_tree, "parse");
+                run.sort = ReadStage(run_tree, "sort");
+                run.build = ReadStage(run_tree, "build");
+                run.dump = ReadStage(run_tree, "dump");
+                run.peak_rss_kb = run_tree.get<long>("peak_rss_kb");
+                run.gates = run_tree.get<uint64_t>("gates");
+                run.nodes = run_tree.get<uint64_t>("nodes");
+                run.peak_live_nodes = run_tree.get<uint64_t>("peak_live_nodes");
+                run.output_nodes = run_tree.get<uint64_t>("output_nodes");
+                run.cache.computedLookups = run_tree.get<uint64_t>("computed_table.lookups");
+                run.cache.computedHits = run_tree.get<uint64_t>("computed_table.hits");
+                run.cache.uniqueLookups = run_tree.get<uint64_t>("unique_table.lookups");
+                run.cache.uniqueHits = run_tree.get<uint64_t>("unique_table.hits");
+                circuit.runs.push_back(run);
+            }
+            results.circuits.push_back(std::move(circuit));
+        }
+    } catch (const boost::property_tree::ptree_error &error) {
+        throw std::runtime_error(json_file + ": " + error.what());
+    }
+    return results;
+}
+
+std::vector<metric_comparison_t> CompareToBaseline(const suite_results_t &baseline, const suite_results_t &current,
+                                                   const regression_tolerance_t &tolerance) {
+    std::vector<metric_comparison_t> comparisons;
+    for (const auto &base : baseline.circuits) {
+        const circuit_runs_t *now = FindComplete(current, base.name);
+        if (FindComplete(baseline, base.name) == nullptr) {
+            continue;
+        }
+        if (now == nullptr) {
+            comparisons.push_back({base.name, "status", 1, 0, true, "missing or not finished in every repetition"});
+            continue;
+        }
+
+        /* Deterministic metrics come from the last run and must not move */
+        const run_record_t &base_run = base.runs.back();
+        const run_record_t &now_run = now->runs.back();
+        for (auto [metric, base_count, now_count] : {
+                std::make_tuple("nodes", base_run.nodes, now_run.nodes),
+                std::make_tuple("peak live nodes", base_run.peak_live_nodes, now_run.peak_live_nodes),
+                std::make_tuple("output nodes", base_run.output_nodes, now_run.output_nodes)}) {
+            bool changed = base_count != now_count;
+            comparisons.push_back({base.name, metric, static_cast<double>(base_count),
+                                   static_cast<double>(now_count), changed,
+                                   changed ? "must match exactly" : ""});
+        }
+
+        double base_hit_rate = HitRate(base_run), now_hit_rate = HitRate(now_run);
+        bool hit_rate_dropped = base_hit_rate - now_hit_rate > tolerance.hit_rate;
+        comparisons.push_back({base.name, "hit rate", base_hit_rate, now_hit_rate, hit_rate_dropped,
+                               hit_rate_dropped ? "dropped by more than " + Format(tolerance.hit_rate) : ""});
+
+        /* Noisy metrics are compared through their medians */
+        auto samples = [](const circuit_runs_t &circuit, auto metric) {
+            std::vector<double> values;
+            for (const auto &run : circuit.runs) {
+                values.push_back(metric(run));
+            }
+            return values;
+        };
+        std::vector<double> base_rss = samples(base, [](const run_record_t &run) {
+            return static_cast<double>(run.peak_rss_kb);
+        });
+        std::vector<double> now_rss = samples(*now, [](const run_record_t &run) {
+            return static_cast<double>(run.peak_rss_kb);
+        });
+        double base_memory = Median(base_rss), now_memory = Median(now_rss);
+        bool memory_grew = now_memory > base_memory * (1 + tolerance.memory);
+        comparisons.push_back({base.name, "peak RSS [kB]", base_memory, now_memory, memory_grew,
+                               memory_grew ? "grew by more than " + Format(100 * tolerance.memory) + "%" : ""});
+
+        size_t repetitions = std::min(base.runs.size(), now->runs.size());
+        bool judged = repetitions >= tolerance.min_repetitions;
+        for (auto [metric, stage] : {std::make_pair("parse [s]", &run_record_t::parse),
+                                     std::make_pair("sort [s]", &run_record_t::sort),
+                                     std::make_pair("build [s]", &run_record_t::build),
+                                     std::make_pair("dump [s]", &run_record_t::dump)}) {
+            auto wall = [stage = stage](const run_record_t &run) { return (run.*stage).wall; };
+            std::vector<double> base_times = samples(base, wall), now_times = samples(*now, wall);
+            double base_time = Median(base_times), now_time = Median(now_times);
+            double noise = tolerance.noise * std::hypot(Spread(base_times), Spread(now_times));
+            double growth = now_time - base_time;
+            bool slower = judged && growth > base_time * tolerance.time && growth > tolerance.min_time &&
+                          growth > noise;
+            comparisons.push_back({base.name, metric, base_time, now_time, slower,
+                                   judged ? "noise " + Format(noise) + " s"
+                                          : "not judged, " + std::to_string(repetitions) + " of " +
+                                            std::to_string(tolerance.min_repetitions) + " repetitions"});
+        }
+    }
+    return comparisons;
+}
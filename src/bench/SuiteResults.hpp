@@ -0,0 +1,110 @@
+//
+// Results of VDSProject_suite and their comparison against a baseline
+//
+
+#pragma once
+
+#include "../Manager.h"
+#include "BenchmarkLib.h"
+#include "CircuitToBDD.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class run_status_t : int32_t {
+    Ok, Failed, Timeout
+};
+
+const char *RunStatusName(run_status_t status);
+
+/**
+ * \brief One repetition of the suite on one circuit
+ *
+ *  Plain data, so that the child process measuring a run can send it to the
+ *   suite through a pipe as is.
+ */
+struct run_record_t {
+    run_status_t status = run_status_t::Failed;
+    stage_time_t parse, sort, build, dump;
+    long peak_rss_kb = 0;
+    uint64_t gates = 0;
+    uint64_t nodes = 0;           ///< Live nodes after the build
+    uint64_t peak_live_nodes = 0;
+    uint64_t output_nodes = 0;    ///< Nodes of all output BDDs, shared ones counted once
+    ClassProject::Manager::CacheStatistics cache;
+};
+
+struct circuit_runs_t {
+    std::string name;
+    std::string file;
+    std::vector<run_record_t> runs;
+};
+
+struct suite_results_t {
+    unsigned repetitions = 0;
+    decomposition_t decomposition = decomposition_t::Linear;
+    std::vector<circuit_runs_t> circuits;
+};
+
+/**
+ * \brief Writes the results as JSON, the format ReadSuiteJson reads
+ */
+void WriteSuiteJson(const std::string &json_file, const suite_results_t &results);
+
+/**
+ * \brief Writes one CSV row per run
+ */
+void WriteSuiteCsv(const std::string &csv_file, const suite_results_t &results);
+
+/**
+ * \brief Reads a file written by WriteSuiteJson
+ *
+ *  Throws std::runtime_error if the file cannot be read or lacks a field.
+ */
+suite_results_t ReadSuiteJson(const std::string &json_file);
+
+/**
+ * \brief How far a run may move away from the baseline before it counts as a regression
+ *
+ *  Times and peak RSS are compared by their medians over the repetitions. A
+ *   time only regresses if its median grew by more than the relative tolerance,
+ *   by more than min_time, and by more than noise times the spread of both
+ *   samples, estimated from their median absolute deviations. A MAD of a
+ *   few samples says little about the noise, so times of a circuit with
+ *   fewer than min_repetitions runs on either side are reported but never
+ *   regress.
+ */
+struct regression_tolerance_t {
+    double time = 0.10;           ///< Relative growth of a stage median
+    double min_time = 0.005;      ///< Seconds; smaller differences are timer noise
+    double noise = 3.0;           ///< Standard deviations, estimated from the MAD
+    unsigned min_repetitions = 5; ///< Runs needed on both sides before times may regress
+    double memory = 0.10;    ///< Relative growth of the peak RSS median
+    double hit_rate = 0.01;  ///< Absolute drop of the computed table hit rate
+};
+
+/**
+ * \brief One metric of one circuit in both results
+ */
+struct metric_comparison_t {
+    std::string circuit;
+    std::string metric;
+    double baseline = 0;
+    double current = 0;
+    bool regression = false;
+    std::string note; ///< Why the metric regressed, or the noise it was compared against
+};
+
+/**
+ * \brief Compares the circuits of the baseline with the same circuits in the current results
+ * \return one entry per compared metric, in the order of the baseline
+ *
+ *  Node counts do not depend on the machine and must match exactly, in both
+ *   directions: a smaller count means the baseline is out of date. A circuit
+ *   of the baseline that is missing, or did not finish every repetition, is a
+ *   regression of its status. Circuits only the current results have, and
+ *   circuits that did not finish in the baseline, are ignored.
+ */
+std::vector<metric_comparison_t> CompareToBaseline(const suite_results_t &baseline, const suite_results_t &current,
+                                                   const regression_tolerance_t &tolerance);
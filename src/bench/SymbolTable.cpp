@@ -0,0 +1,41 @@
+//
+// Interning of circuit labels
+//
+
+#include "SymbolTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+symbol_t SymbolTable::Intern(std::string_view name) {
+    auto found = index.find(name);
+    if (found != index.end()) {
+        return found->second;
+    }
+
+    /* Labels longer than a chunk get a chunk of their own */
+    if (chunk_free < name.size()) {
+        size_t size = std::max(name.size(), CHUNK_SIZE);
+        chunks.emplace_back(new char[size]);
+        chunk_next = chunks.back().get();
+        chunk_free = size;
+    }
+    char *storage = chunk_next;
+    std::memcpy(storage, name.data(), name.size());
+    chunk_next += name.size();
+    chunk_free -= name.size();
+
+    auto symbol = static_cast<symbol_t>(names.size());
+    names.emplace_back(storage, name.size());
+    index.emplace(names.back(), symbol);
+    return symbol;
+}
+
+bool SymbolTable::Find(std::string_view name, symbol_t &symbol) const {
+    auto found = index.find(name);
+    if (found == index.end()) {
+        return false;
+    }
+    symbol = found->second;
+    return true;
+}
@@ -0,0 +1,58 @@
+//
+// Interning of circuit labels
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t symbol_t; ///< Type definition for an interned label
+
+/**
+ * \class SymbolTable
+ *
+ * \brief Maps every distinct label to a dense symbol number and back.
+ *
+ *  The characters of each distinct label are copied once into chunked
+ *   storage owned by the table, so the views returned by Name stay valid
+ *   for the lifetime of the table, also after a move.
+ *
+ */
+class SymbolTable {
+
+public:
+
+    /**
+     * \brief Returns the symbol of name, adding it if it is new
+     * \param name the label to intern
+     * \return symbol_t
+     */
+    symbol_t Intern(std::string_view name);
+
+    /**
+     * \brief Looks up a label without adding it
+     * \param name the label to search for
+     * \param symbol receives the symbol if found
+     * \return true if the label is known
+     */
+    bool Find(std::string_view name, symbol_t &symbol) const;
+
+    std::string_view Name(symbol_t symbol) const { return names[symbol]; }
+
+    size_t Size() const { return names.size(); }
+
+private:
+
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    std::vector<std::unique_ptr<char[]>> chunks; ///< Storage of the label characters
+    char *chunk_next = nullptr;                  ///< First unused byte of the last chunk
+    size_t chunk_free = 0;                       ///< Unused bytes in the last chunk
+
+    std::vector<std::string_view> names;                   ///< Label of each symbol
+    std::unordered_map<std::string_view, symbol_t> index; ///< Symbol of each label
+};
@@ -5,42 +5,367 @@
 
 #include <iostream>
 #include <string>
+#include <filesystem>
+#include <chrono>
 
 #include "Manager.h"
 #include "BenchParser.hpp"
+#include "CircuitOptimizer.hpp"
+#include "CircuitSimulator.hpp"
 #include "CircuitToBDD.hpp"
 #include "BenchmarkLib.h"
+#include "ResultCache.hpp"
+#include "VerifyLib.h"
 
 int main(int argc, char *argv[]) {
 
-    if (2 > argc) {
+    bool resume = false;
+    bool incremental = false;
+    bool stream = false;
+    bool optimize = false;
+    bool release = false;
+    decomposition_t decomposition = decomposition_t::Linear;
+    size_t simulate_passes = 0;
+    unsigned simulate_words = 4;
+    unsigned dump_threads = 0;
+    std::string cache_dir;
+    std::string bench_file;
+    std::string equiv_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--resume") {
+            resume = true;
+        } else if (arg == "--incremental") {
+            incremental = true;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--optimize") {
+            optimize = true;
+        } else if (arg == "--release") {
+            release = true;
+        } else if (arg == "--decompose" && i + 1 < argc) {
+            if (!ParseDecomposition(argv[++i], decomposition)) {
+                std::cout << "Unknown decomposition strategy: " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--simulate" && i + 1 < argc) {
+            simulate_passes = std::stoul(argv[++i]);
+        } else if (arg == "--simulate-words" && i + 1 < argc) {
+            simulate_words = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--dump-threads" && i + 1 < argc) {
+            dump_threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--equiv" && i + 2 < argc) {
+            bench_file = argv[++i];
+            equiv_file = argv[++i];
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (bench_file.empty()) {
+            bench_file = arg;
+        } else {
+            std::cout << "Unexpected argument: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    if (bench_file.empty()) {
         std::cout << "Must specify a filename!" << std::endl;
+        std::cout << "Usage: " << argv[0] << " [--resume | --incremental | --stream] [--optimize] [--release]"
+                  << " [--decompose linear|balanced|greedy] [--simulate <passes> [--simulate-words 1|2|4|8]]"
+                  << " [--dump-threads N] [--cache-dir <dir>] <file.bench|.aag|.aig|.blif>"
+                  << std::endl;
+        std::cout << "       " << argv[0] << " [--decompose linear|balanced|greedy] --equiv <first> <second>"
+                  << std::endl;
+        return -1;
+    }
+    if (!equiv_file.empty() && (resume || incremental || stream || optimize || release || simulate_passes > 0 ||
+                                !cache_dir.empty())) {
+        std::cout << "--equiv can only be combined with --decompose" << std::endl;
+        return -1;
+    }
+    if (stream && (resume || incremental)) {
+        std::cout << "--stream cannot be combined with --resume or --incremental" << std::endl;
+        return -1;
+    }
+    if (stream && optimize) {
+        std::cout << "--stream cannot be combined with --optimize" << std::endl;
+        return -1;
+    }
+    if (simulate_passes > 0 && (stream || !cache_dir.empty())) {
+        std::cout << "--simulate cannot be combined with --stream or --cache-dir" << std::endl;
+        return -1;
+    }
+    /* RestoreGateMap only drops IDs beyond the restored node count. After a
+       collection, an ID in the gate map may have been freed and reused for
+       another node, which that filter cannot detect. */
+    if (release && (stream || resume || incremental)) {
+        std::cout << "--release cannot be combined with --stream, --resume or --incremental" << std::endl;
+        return -1;
+    }
+    if (stream && std::filesystem::path(bench_file).extension() != ".bench") {
+        std::cout << "--stream reads .bench files only" << std::endl;
         return -1;
     }
 
-    std::string bench_file = argv[1];
+    auto BDD_manager = make_shared<ClassProject::Manager>();
+    auto circuit2BDD = make_unique<CircuitToBDD>(BDD_manager);
+    circuit2BDD->SetDecomposition(decomposition);
+    circuit2BDD->SetEarlyRelease(release);
+    circuit2BDD->SetDumpThreads(dump_threads);
+
+    /* Writing the output files is timed apart from building the BDDs */
+    auto print_bdds = [&](const std::set<label_t> &output_labels) {
+        auto wall_start = std::chrono::steady_clock::now();
+        circuit2BDD->PrintBDD(output_labels);
+        std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - wall_start;
+        return wall_time.count();
+    };
+
+    /* Sizes of the output BDDs, from one traversal over all of them */
+    auto print_output_statistics = [&](const std::set<label_t> &output_labels) {
+        std::vector<ClassProject::BDD_ID> roots;
+        for (const auto &output : circuit2BDD->GetOutputBDDs(output_labels)) {
+            roots.push_back(output.second);
+        }
+        ClassProject::RootAnalysis analysis = BDD_manager->analyzeRoots(roots);
+        size_t summed = 0, largest_support = 0;
+        for (size_t root = 0; root < roots.size(); ++root) {
+            summed += analysis.nodeCounts[root];
+            size_t support = 0;
+            for (uint64_t word : analysis.supports[root]) {
+                support += static_cast<size_t>(__builtin_popcountll(word));
+            }
+            largest_support = std::max(largest_support, support);
+        }
+        std::cout << " Outputs: " << analysis.sharedNodeCount << " nodes shared, " << summed
+                  << " summed over " << roots.size() << " outputs; largest support " << largest_support << " of "
+                  << analysis.variables.size() << " variables" << std::endl;
+    };
+
+    double user_time, vm1, rss1, vm2, rss2;
+    process_mem_usage(vm1, rss1);
+
+    /* With --equiv both circuits are built into the manager output by output, until two outputs differ */
+    if (!equiv_file.empty()) {
+        BenchParser first(bench_file);
+        BenchParser second(equiv_file);
+        std::cout << "- Checking equivalence of " << bench_file << " and " << equiv_file << "...";
+        user_time = userTime();
+        circuit_mismatch_t mismatch;
+        size_t compared = 0;
+        bool equivalent = CheckCircuitEquivalence(BDD_manager, first.GetCircuit(), second.GetCircuit(), mismatch,
+                                                  compared, decomposition);
+        user_time = userTime() - user_time;
+        if (equivalent) {
+            std::cout << " Equivalent! (" << compared << " outputs)" << std::endl << std::endl;
+        } else if (!mismatch.unmatched.empty()) {
+            std::cout << " Not Equivalent! Outputs of only one circuit:";
+            for (const auto &output : mismatch.unmatched) {
+                std::cout << " " << output;
+            }
+            std::cout << std::endl << std::endl;
+        } else {
+            std::cout << " Not Equivalent! " << compared << " outputs agree, " << mismatch.output
+                      << " is " << mismatch.counterexample.first_value << " in the first and "
+                      << !mismatch.counterexample.first_value << " in the second circuit for:";
+            for (const auto &value : mismatch.counterexample.assignment) {
+                std::cout << " " << value.first << "=" << value.second;
+            }
+            std::cout << " (all other inputs 0)" << std::endl << std::endl;
+        }
+
+        std::cout << "**** Performance ****" << std::endl;
+        std::cout << " Runtime: " << user_time << std::endl;
+        std::cout << " Decomposition: " << DecompositionName(decomposition) << std::endl;
+        std::cout << " Nodes: " << BDD_manager->liveNodeCount() << " live, " << BDD_manager->peakLiveNodeCount()
+                  << " at peak" << std::endl;
+        process_mem_usage(vm2, rss2);
+        std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
+        return equivalent ? 0 : 1;
+    }
+
+    /* Every option that changes the generated BDDs must be part of the cache key */
+    std::string build_options = stream ? "stream" : optimize ? "optimize" : "default";
+    if (decomposition != decomposition_t::Linear) {
+        build_options += std::string("+") + DecompositionName(decomposition);
+    }
+    if (release) {
+        build_options += "+release";
+    }
+
+    /* On a cache hit the output BDDs are loaded instead of parsing and building the circuit */
+    std::unique_ptr<ResultCache> cache;
+    cache_key_t cache_key;
+    if (!cache_dir.empty()) {
+        cache = make_unique<ResultCache>(cache_dir);
+        cache_key = ResultCache::Key(bench_file, build_options);
+
+        std::map<label_t, ClassProject::BDD_ID> outputs;
+        user_time = userTime();
+        if (cache->Lookup(cache_key, *BDD_manager, outputs)) {
+            user_time = userTime() - user_time;
+            std::cout << "- Loaded " << outputs.size() << " output BDDs from cache entry " << cache_key.name << std::endl
+                      << std::endl;
+
+            std::set<label_t> output_labels;
+            for (const auto &output : outputs) {
+                output_labels.insert(output.first);
+            }
+            circuit2BDD->UseOutputBDDs(outputs, bench_file);
+            double dump_time = print_bdds(output_labels);
+
+            std::cout << "**** Performance ****" << std::endl;
+            std::cout << " Runtime: " << user_time << " (cache hit)" << std::endl;
+            std::cout << " Dump: " << dump_time << " (wall)" << std::endl;
+            process_mem_usage(vm2, rss2);
+            std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
+            return 0;
+        }
+    }
+
+    /* With --stream the file is parsed on a second thread while the BDDs are built */
+    if (stream) {
+        std::cout << "- Generating BDD while parsing...";
+        user_time = userTime();
+        auto wall_start = std::chrono::steady_clock::now();
+        std::set<label_t> output_labels = circuit2BDD->StreamBDD(bench_file);
+        user_time = userTime() - user_time;
+        std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - wall_start;
+        std::cout << " BDD generated successfully!" << std::endl << std::endl;
+
+        if (cache) {
+            cache->Store(cache_key, *BDD_manager, circuit2BDD->GetOutputBDDs(output_labels));
+        }
+
+        double dump_time = print_bdds(output_labels);
+
+        std::cout << "**** Performance ****" << std::endl;
+        std::cout << " Runtime: " << user_time << " (wall " << wall_time.count() << ", parsing included)" << std::endl;
+        std::cout << " Dump: " << dump_time << " (wall)" << std::endl;
+        std::cout << " Decomposition: " << DecompositionName(decomposition) << std::endl;
+        print_output_statistics(output_labels);
+        process_mem_usage(vm2, rss2);
+        std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
+        return 0;
+    }
 
     /* Parse the circuit from file and generate topological sorted circuit */
     BenchParser parsed_circuit(bench_file);
 
-    auto BDD_manager = make_shared<ClassProject::Manager>();
-    auto circuit2BDD = make_unique<CircuitToBDD>(BDD_manager);
+    /* With --optimize the BDDs are built from the simplified circuit */
+    Circuit optimized_circuit;
+    std::vector<gate_t> optimized_order;
+    if (optimize) {
+        std::cout << "- Optimizing circuit...";
+        user_time = userTime();
+        optimize_stats_t stats;
+        optimized_circuit = OptimizeCircuit(parsed_circuit.GetCircuit(), parsed_circuit.GetSortedCircuit(), stats);
+        optimized_order = TopologicalOrder(optimized_circuit);
+        std::cout << " " << stats.operations_before << " -> " << stats.operations_after << " gate operations ("
+                  << stats.merged << " merged, " << stats.bypassed << " bypassed, " << stats.constants
+                  << " constant) in " << userTime() - user_time << "s" << std::endl;
+    }
+    const Circuit &circuit = optimize ? optimized_circuit : parsed_circuit.GetCircuit();
+    const std::vector<gate_t> &order = optimize ? optimized_order : parsed_circuit.GetSortedCircuit();
 
-    double user_time, vm1, rss1, vm2, rss2;
+    /* Random simulation gives signal statistics before, and a cross-check after, the BDDs are built */
+    std::unique_ptr<CircuitSimulator> simulator;
+    if (simulate_passes > 0) {
+        simulator = make_unique<CircuitSimulator>(circuit, order, simulate_words);
+        std::cout << "- Simulating " << simulate_passes << " x " << simulator->PatternsPerPass()
+                  << " random patterns...";
+        auto wall_start = std::chrono::steady_clock::now();
+        simulator->Run(simulate_passes, 1);
+        std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - wall_start;
+
+        double min_probability = 1, max_probability = 0, toggle_sum = 0;
+        for (gate_t output : circuit.Outputs()) {
+            gate_t gate = circuit.Fanins(output)[0];
+            min_probability = std::min(min_probability, simulator->SignalProbability(gate));
+            max_probability = std::max(max_probability, simulator->SignalProbability(gate));
+            toggle_sum += simulator->ToggleRate(gate);
+        }
+        std::filesystem::create_directories(CircuitToBDD::ResultDir(bench_file));
+        simulator->WriteReport(CircuitToBDD::ResultDir(bench_file) + "/simulation.csv");
+        std::cout << " done in " << wall_time.count() << "s ("
+                  << static_cast<double>(simulator->Patterns()) * static_cast<double>(circuit.Size()) /
+                     wall_time.count() / 1e6 << " M gate evaluations/s)" << std::endl;
+        std::cout << "  Outputs: signal probability " << min_probability << " to " << max_probability
+                  << ", mean toggle rate " << toggle_sum / static_cast<double>(circuit.Outputs().size())
+                  << std::endl;
+    }
+
+    /* With --resume the manager is checkpointed while building, and a previous
+       checkpoint is restored so that gates built before are skipped.
+       --incremental additionally rebuilds the cones of gates changed since the
+       run that wrote the circuit signature. */
+    std::string result_dir = CircuitToBDD::ResultDir(bench_file);
+    std::string checkpoint_file = result_dir + "/manager.ckpt";
+    std::string gate_map_file = result_dir + "/gates.ckpt";
+    std::string signature_file = result_dir + "/circuit.sig";
+    /* Both files are replaced by a rename, the manager first: a crash in
+       between leaves a gate map whose IDs all exist in the newer checkpoint */
+    auto write_checkpoint = [&]() {
+        BDD_manager->checkpoint(checkpoint_file + ".tmp", true);
+        std::filesystem::rename(checkpoint_file + ".tmp", checkpoint_file);
+        circuit2BDD->SaveGateMap(gate_map_file);
+    };
+    if (resume || incremental) {
+        if (std::filesystem::exists(checkpoint_file) && std::filesystem::exists(gate_map_file) &&
+            (!incremental || std::filesystem::exists(signature_file))) {
+            std::cout << "- Restoring manager from " << checkpoint_file << "...";
+            user_time = userTime();
+            BDD_manager->restore(checkpoint_file);
+            size_t restored = circuit2BDD->RestoreGateMap(gate_map_file, BDD_manager->uniqueTableSize());
+            std::cout << " " << restored << " gates restored in " << userTime() - user_time << "s" << std::endl;
+            if (incremental) {
+                size_t to_build = circuit2BDD->InvalidateChangedGates(circuit, order, signature_file);
+                std::cout << "- " << to_build << " gates changed or depend on a changed gate" << std::endl;
+            }
+        }
+        circuit2BDD->SetCheckpointHook(write_checkpoint, std::chrono::seconds(60));
+    }
 
     std::cout << "- Generating BDD from circuit...";
-    process_mem_usage(vm1, rss1);
     user_time = userTime();
-    circuit2BDD->GenerateBDD(parsed_circuit.GetSortedCircuit(), bench_file);
+    circuit2BDD->GenerateBDD(circuit, order, bench_file);
     user_time = userTime() - user_time;
     std::cout << " BDD generated successfully!" << std::endl << std::endl;
 
-    circuit2BDD->PrintBDD(parsed_circuit.GetListOfOutputLabels());
+    int exit_code = 0;
+    if (simulator) {
+        std::cout << "- Cross-checking BDDs with " << simulator->PatternsPerPass() << " simulated patterns...";
+        size_t mismatches = simulator->CheckBDDs(*BDD_manager,
+                                                 circuit2BDD->GetOutputBDDs(parsed_circuit.GetListOfOutputLabels()));
+        if (mismatches == 0) {
+            std::cout << " all outputs agree" << std::endl << std::endl;
+        } else {
+            std::cout << " " << mismatches << " output values differ!" << std::endl << std::endl;
+            exit_code = 1;
+        }
+    }
+
+    if (resume || incremental) {
+        write_checkpoint();
+    }
+    if (incremental) {
+        CircuitToBDD::SaveCircuitSignature(circuit, order, signature_file);
+    }
+
+    if (cache) {
+        cache->Store(cache_key, *BDD_manager, circuit2BDD->GetOutputBDDs(parsed_circuit.GetListOfOutputLabels()));
+    }
+
+    double dump_time = print_bdds(parsed_circuit.GetListOfOutputLabels());
 
     std::cout << "**** Performance ****" << std::endl;
     std::cout << " Runtime: " << user_time << std::endl;
+    std::cout << " Dump: " << dump_time << " (wall)" << std::endl;
+    std::cout << " Decomposition: " << DecompositionName(decomposition) << std::endl;
+    std::cout << " Nodes: " << BDD_manager->liveNodeCount() << " live, " << BDD_manager->peakLiveNodeCount()
+              << " at peak" << std::endl;
+    print_output_statistics(parsed_circuit.GetListOfOutputLabels());
     process_mem_usage(vm2, rss2);
     std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
 
-    return 0;
+    return exit_code;
 }
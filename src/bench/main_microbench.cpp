@@ -0,0 +1,274 @@
+//
+// Google Benchmark micro-benchmarks of the Manager primitives on synthetic BDD families
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Manager.h"
+
+using ClassProject::BDD_ID;
+using ClassProject::Manager;
+
+namespace {
+    enum family_t : int64_t {
+        Chain, Adder, Multiplier, Random
+    };
+
+    const char *FamilyName(int64_t family) {
+        switch (family) {
+            case Chain:
+                return "chain";
+            case Adder:
+                return "adder";
+            case Multiplier:
+                return "multiplier";
+            default:
+                return "random";
+        }
+    }
+
+    /* A manager holding the outputs of one family member, at least two of them */
+    struct instance_t {
+        std::unique_ptr<Manager> manager;
+        std::vector<BDD_ID> vars;
+        std::vector<BDD_ID> outputs;
+    };
+
+    /* SplitMix64, as in CircuitSimulator */
+    uint64_t NextRandom(uint64_t &state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /* Adds b to the bits of sum, from bit shift on, and returns the carry out */
+    BDD_ID AddInto(Manager &manager, std::vector<BDD_ID> &sum, const std::vector<BDD_ID> &b, size_t shift) {
+        BDD_ID carry = manager.False();
+        for (size_t i = 0; i < b.size(); ++i) {
+            BDD_ID a = sum[shift + i];
+            BDD_ID half = manager.xor2(a, b[i]);
+            sum[shift + i] = manager.xor2(half, carry);
+            carry = manager.or2(manager.and2(a, b[i]), manager.and2(half, carry));
+        }
+        return carry;
+    }
+
+    /**
+     * chain:      the parities of xi..xn-1 for all i, n variables
+     * adder:      the sum and carry out of two n bit numbers, bits interleaved
+     * multiplier: the 2n product bits of two n bit numbers, as an array of adders
+     * random:     4n random AND, OR and XOR gates over n variables, with a fixed seed
+     */
+    instance_t Build(int64_t family, int64_t size) {
+        instance_t instance{std::make_unique<Manager>(), {}, {}};
+        Manager &manager = *instance.manager;
+        auto n = static_cast<size_t>(size);
+        switch (family) {
+            case Chain: {
+                for (size_t i = 0; i < n; ++i) {
+                    instance.vars.push_back(manager.createVar("x" + std::to_string(i)));
+                }
+                /* Each suffix parity shares all nodes of the next one */
+                BDD_ID parity = manager.False();
+                for (size_t i = n; i-- > 0;) {
+                    parity = manager.xor2(instance.vars[i], parity);
+                    instance.outputs.push_back(parity);
+                }
+                break;
+            }
+            case Adder: {
+                std::vector<BDD_ID> a, b;
+                for (size_t i = 0; i < n; ++i) {
+                    a.push_back(manager.createVar("a" + std::to_string(i)));
+                    b.push_back(manager.createVar("b" + std::to_string(i)));
+                }
+                instance.vars = a;
+                instance.vars.insert(instance.vars.end(), b.begin(), b.end());
+                instance.outputs = a;
+                instance.outputs.push_back(AddInto(manager, instance.outputs, b, 0));
+                break;
+            }
+            case Multiplier: {
+                std::vector<BDD_ID> a, b;
+                for (size_t i = 0; i < n; ++i) {
+                    a.push_back(manager.createVar("a" + std::to_string(i)));
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    b.push_back(manager.createVar("b" + std::to_string(i)));
+                }
+                instance.vars = a;
+                instance.vars.insert(instance.vars.end(), b.begin(), b.end());
+                instance.outputs.assign(2 * n, manager.False());
+                for (size_t i = 0; i < n; ++i) {
+                    std::vector<BDD_ID> partial;
+                    for (size_t j = 0; j < n; ++j) {
+                        partial.push_back(manager.and2(a[j], b[i]));
+                    }
+                    instance.outputs[i + n] = AddInto(manager, instance.outputs, partial, i);
+                }
+                break;
+            }
+            default: {
+                uint64_t state = 0x5eed + n;
+                std::vector<BDD_ID> pool;
+                for (size_t i = 0; i < n; ++i) {
+                    instance.vars.push_back(manager.createVar("x" + std::to_string(i)));
+                    pool.push_back(instance.vars.back());
+                }
+                for (size_t i = 0; i < 4 * n; ++i) {
+                    BDD_ID left = pool[NextRandom(state) % pool.size()];
+                    BDD_ID right = pool[NextRandom(state) % pool.size()];
+                    switch (NextRandom(state) % 3) {
+                        case 0:
+                            pool.push_back(manager.and2(left, right));
+                            break;
+                        case 1:
+                            pool.push_back(manager.or2(left, right));
+                            break;
+                        default:
+                            pool.push_back(manager.xor2(left, right));
+                            break;
+                    }
+                }
+                instance.outputs.assign(pool.end() - static_cast<std::ptrdiff_t>(n), pool.end());
+                break;
+            }
+        }
+        return instance;
+    }
+
+    /* The operands of the binary and ternary benchmarks */
+    BDD_ID First(const instance_t &instance) { return instance.outputs[instance.outputs.size() / 2]; }
+
+    BDD_ID Second(const instance_t &instance) { return instance.outputs.back(); }
+
+    BDD_ID Third(const instance_t &instance) { return instance.outputs[instance.outputs.size() / 3]; }
+
+    void FamilyArgs(benchmark::internal::Benchmark *benchmark) {
+        benchmark->ArgNames({"family", "n"});
+        for (int64_t n : {256, 1024, 4096}) benchmark->Args({Chain, n});
+        for (int64_t n : {16, 32, 64}) benchmark->Args({Adder, n});
+        for (int64_t n : {4, 6, 8}) benchmark->Args({Multiplier, n});
+        for (int64_t n : {12, 16, 20}) benchmark->Args({Random, n});
+    }
+
+    /**
+     * Times one operation on a family member, each iteration in a fresh copy of
+     * the manager it was built in, so that the computed table holds the results
+     * of the build but none of the operation
+     */
+    template<typename Operation>
+    void MeasureUncached(benchmark::State &state, Operation operation) {
+        instance_t built = Build(state.range(0), state.range(1));
+        instance_t instance{nullptr, built.vars, built.outputs};
+        size_t created = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            instance.manager = std::make_unique<Manager>(*built.manager);
+            state.ResumeTiming();
+            benchmark::DoNotOptimize(operation(instance));
+            created = instance.manager->uniqueTableSize() - built.manager->uniqueTableSize();
+        }
+        state.SetLabel(FamilyName(state.range(0)));
+        state.counters["new_nodes"] = static_cast<double>(created);
+    }
+}
+
+static void BM_CreateVar(benchmark::State &state) {
+    std::vector<std::string> labels;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        labels.push_back("x" + std::to_string(i));
+    }
+    std::unique_ptr<Manager> manager;
+    for (auto _ : state) {
+        state.PauseTiming();
+        manager = std::make_unique<Manager>();
+        state.ResumeTiming();
+        for (const auto &label : labels) {
+            benchmark::DoNotOptimize(manager->createVar(label));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateVar)->Arg(64)->Arg(1024)->Arg(16384);
+
+static void BM_Build(benchmark::State &state) {
+    size_t nodes = 0;
+    for (auto _ : state) {
+        instance_t instance = Build(state.range(0), state.range(1));
+        nodes = instance.manager->uniqueTableSize();
+    }
+    state.SetLabel(FamilyName(state.range(0)));
+    state.counters["nodes"] = static_cast<double>(nodes);
+}
+BENCHMARK(BM_Build)->Apply(FamilyArgs);
+
+static void BM_And2(benchmark::State &state) {
+    MeasureUncached(state, [](instance_t &instance) { return instance.manager->and2(First(instance), Second(instance)); });
+}
+BENCHMARK(BM_And2)->Apply(FamilyArgs);
+
+static void BM_Xor2(benchmark::State &state) {
+    MeasureUncached(state, [](instance_t &instance) { return instance.manager->xor2(First(instance), Second(instance)); });
+}
+BENCHMARK(BM_Xor2)->Apply(FamilyArgs);
+
+static void BM_Ite(benchmark::State &state) {
+    MeasureUncached(state, [](instance_t &instance) {
+        return instance.manager->ite(Third(instance), First(instance), Second(instance));
+    });
+}
+BENCHMARK(BM_Ite)->Apply(FamilyArgs);
+
+static void BM_Neg(benchmark::State &state) {
+    MeasureUncached(state, [](instance_t &instance) { return instance.manager->neg(Second(instance)); });
+}
+BENCHMARK(BM_Neg)->Apply(FamilyArgs);
+
+/* The same and2 over and over: the cost of a computed table hit */
+static void BM_And2Cached(benchmark::State &state) {
+    instance_t instance = Build(state.range(0), state.range(1));
+    BDD_ID f = First(instance), g = Second(instance);
+    instance.manager->and2(f, g);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(instance.manager->and2(f, g));
+    }
+    state.SetLabel(FamilyName(state.range(0)));
+}
+BENCHMARK(BM_And2Cached)->Apply(FamilyArgs);
+
+/* Cofactors by the eighth variable of the order; the recursion is not memoized, so it follows every path above it */
+static void BM_CoFactorTrue(benchmark::State &state) {
+    instance_t instance = Build(state.range(0), state.range(1));
+    std::vector<BDD_ID> order = instance.vars;
+    std::sort(order.begin(), order.end());
+    BDD_ID f = Second(instance), x = order[std::min<size_t>(7, order.size() - 1)];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(instance.manager->coFactorTrue(f, x));
+    }
+    state.SetLabel(FamilyName(state.range(0)));
+}
+BENCHMARK(BM_CoFactorTrue)->Apply(FamilyArgs);
+
+static void BM_FindNodes(benchmark::State &state) {
+    instance_t instance = Build(state.range(0), state.range(1));
+    BDD_ID f = Second(instance);
+    std::set<BDD_ID> nodes;
+    for (auto _ : state) {
+        nodes.clear();
+        instance.manager->findNodes(f, nodes);
+    }
+    state.SetLabel(FamilyName(state.range(0)));
+    state.counters["nodes"] = static_cast<double>(nodes.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(nodes.size()));
+}
+BENCHMARK(BM_FindNodes)->Apply(FamilyArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+//
+// Parse throughput of the bench tokenizer compared to the Boost.Spirit grammar,
+// and scaling of the chunked tokenizer with the number of threads
+//
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchTokenizer.hpp"
+#include "../MappedFile.hpp"
+#include "bench_grammar.hpp"
+#include "skip_parser.hpp"
+
+namespace {
+
+    /* Reference: the istream_iterator based Boost.Spirit path BenchParser used before */
+    size_t ParseWithSpirit(const std::string &bench_file) {
+        std::ifstream in(bench_file);
+        if (!in.is_open()) {
+            throw std::runtime_error("Could not open file: " + bench_file);
+        }
+        in.unsetf(std::ios::skipws);
+
+        boost::spirit::istream_iterator first(in), last;
+        skip_p::skip_grammar<boost::spirit::istream_iterator> skip;
+        bench_format::bench_parser<boost::spirit::istream_iterator> bench_grammar_parser;
+        bench_format::bench_node_type parsed_bench_node;
+
+        size_t statements = 0;
+        while (first != last) {
+            if (!phrase_parse(first, last, bench_grammar_parser, skip, parsed_bench_node)) {
+                throw std::runtime_error("Spirit grammar rejected " + bench_file);
+            }
+            parsed_bench_node = bench_format::bench_node_type();
+            statements++;
+        }
+        return statements;
+    }
+
+    size_t ParseWithTokenizer(const std::string &bench_file, unsigned threads) {
+        MappedFile file(bench_file);
+        SymbolTable symbols;
+        return TokenizeBench(file.begin(), file.end(), symbols, threads).size();
+    }
+
+    /* Writes a random combinational netlist of roughly the given number of
+       gates. Every gate reads from the most recent signals, so the file has
+       the long chains of forward references of real, large netlists. */
+    void GenerateNetlist(size_t gates, const std::string &bench_file) {
+        std::ofstream out(bench_file);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file: " + bench_file);
+        }
+        const char *types[] = {"AND", "OR", "NAND", "NOR", "XOR"};
+        std::mt19937 random(1);
+        size_t inputs = std::max<size_t>(2, gates / 50);
+        for (size_t i = 0; i < inputs; ++i) {
+            out << "INPUT(in" << i << ")\n";
+        }
+        for (size_t i = gates - gates / 100; i < gates; ++i) {
+            out << "OUTPUT(g" << i << ")\n";
+        }
+        for (size_t i = 0; i < gates; ++i) {
+            size_t signals = inputs + i;
+            out << "g" << i << " = " << types[random() % 5] << "(";
+            for (int k = 0; k < 2; ++k) {
+                size_t signal = signals - 1 - random() % std::min<size_t>(signals, 64);
+                out << (k ? ", " : "");
+                if (signal < inputs) {
+                    out << "in" << signal;
+                } else {
+                    out << "g" << signal - inputs;
+                }
+            }
+            out << ")\n";
+        }
+    }
+
+    template<typename Parse>
+    double BestTime(Parse parse, const std::string &bench_file, int repeat, size_t &statements) {
+        double best = 0;
+        for (int i = 0; i < repeat; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            statements = parse(bench_file);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (i == 0 || elapsed.count() < best) {
+                best = elapsed.count();
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    int repeat = 3;
+    bool with_spirit = true;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> bench_files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::stoi(argv[++i]);
+        } else if (arg == "--no-spirit") {
+            with_spirit = false;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--generate" && i + 2 < argc) {
+            size_t gates = std::stoul(argv[++i]);
+            GenerateNetlist(gates, argv[++i]);
+            bench_files.push_back(argv[i]);
+        } else {
+            bench_files.push_back(arg);
+        }
+    }
+
+    if (bench_files.empty() || repeat < 1 || threads < 1) {
+        std::cout << "Usage: " << argv[0]
+                  << " [--repeat N] [--threads N] [--no-spirit] [--generate <gates> <out.bench>] <file.bench>..."
+                  << std::endl;
+        return -1;
+    }
+
+    std::string threads_column = std::to_string(threads) + " threads MB/s";
+    std::cout << std::left << std::setw(28) << "file" << std::right << std::setw(12) << "statements"
+              << std::setw(12) << "MB" << std::setw(16) << "1 thread MB/s" << std::setw(18) << threads_column
+              << std::setw(14) << "spirit MB/s" << std::setw(10) << "speedup" << std::endl;
+
+    for (const auto &bench_file : bench_files) {
+        double megabytes = MappedFile(bench_file).size() / 1e6;
+
+        size_t statements = 0, threaded_statements = 0, spirit_statements = 0;
+        double tokenizer_time = BestTime([](const std::string &file) { return ParseWithTokenizer(file, 1); },
+                                         bench_file, repeat, statements);
+        double threaded_time = BestTime([threads](const std::string &file) {
+            return ParseWithTokenizer(file, threads);
+        }, bench_file, repeat, threaded_statements);
+
+        std::cout << std::left << std::setw(28) << std::filesystem::path(bench_file).filename().string() << std::right << std::setw(12) << statements
+                  << std::setw(12) << std::fixed << std::setprecision(3) << megabytes
+                  << std::setw(16) << std::setprecision(1) << megabytes / tokenizer_time
+                  << std::setw(18) << megabytes / threaded_time;
+        if (threaded_statements != statements) {
+            std::cout << "  (threaded statement count differs: " << threaded_statements << ")";
+        }
+        if (with_spirit) {
+            double spirit_time = BestTime(ParseWithSpirit, bench_file, repeat, spirit_statements);
+            std::cout << std::setw(14) << megabytes / spirit_time << std::setw(9) << spirit_time / tokenizer_time
+                      << "x";
+            if (spirit_statements != statements) {
+                std::cout << "  (statement count differs: " << spirit_statements << ")";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
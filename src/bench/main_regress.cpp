@@ -0,0 +1,88 @@
+//
+// Compares results of VDSProject_suite against a baseline and fails on regressions
+//
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "SuiteResults.hpp"
+
+int main(int argc, char *argv[]) {
+
+    regression_tolerance_t tolerance;
+    std::string baseline_file, current_file;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--time" && i + 1 < argc) {
+            tolerance.time = std::stod(argv[++i]);
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            tolerance.min_time = std::stod(argv[++i]);
+        } else if (arg == "--noise" && i + 1 < argc) {
+            tolerance.noise = std::stod(argv[++i]);
+        } else if (arg == "--min-repeat" && i + 1 < argc) {
+            tolerance.min_repetitions = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--memory" && i + 1 < argc) {
+            tolerance.memory = std::stod(argv[++i]);
+        } else if (arg == "--hit-rate" && i + 1 < argc) {
+            tolerance.hit_rate = std::stod(argv[++i]);
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else if (arg.rfind("--", 0) != 0 && baseline_file.empty()) {
+            baseline_file = arg;
+        } else if (arg.rfind("--", 0) != 0 && current_file.empty()) {
+            current_file = arg;
+        } else {
+            baseline_file.clear();
+            break;
+        }
+    }
+    if (baseline_file.empty() || current_file.empty()) {
+        std::cout << "Usage: " << argv[0] << " <baseline.json> <current.json> [--time <fraction>]"
+                  << " [--min-time <seconds>] [--noise <deviations>] [--min-repeat N] [--memory <fraction>]"
+                  << " [--hit-rate <fraction>] [--verbose]" << std::endl;
+        std::cout << "  Both files are written by VDSProject_suite --json. Exits with 1 on a regression." << std::endl;
+        return -1;
+    }
+
+    suite_results_t baseline, current;
+    try {
+        baseline = ReadSuiteJson(baseline_file);
+        current = ReadSuiteJson(current_file);
+    } catch (const std::exception &error) {
+        std::cout << error.what() << std::endl;
+        return -1;
+    }
+    if (baseline.decomposition != current.decomposition) {
+        std::cout << "The baseline was built with --decompose " << DecompositionName(baseline.decomposition)
+                  << ", the current results with " << DecompositionName(current.decomposition) << std::endl;
+        return -1;
+    }
+
+    std::vector<metric_comparison_t> comparisons = CompareToBaseline(baseline, current, tolerance);
+    size_t regressions = 0;
+    std::cout << std::left << std::setw(12) << "circuit" << std::setw(18) << "metric" << std::right << std::setw(14)
+              << "baseline" << std::setw(14) << "current" << std::setw(10) << "change" << std::endl;
+    for (const auto &comparison : comparisons) {
+        if (comparison.regression) {
+            regressions++;
+        } else if (!verbose) {
+            continue;
+        }
+        std::cout << std::left << std::setw(12) << comparison.circuit << std::setw(18) << comparison.metric
+                  << std::right << std::setprecision(6) << std::setw(14) << comparison.baseline << std::setw(14)
+                  << comparison.current << std::setw(9) << std::fixed << std::setprecision(1);
+        if (comparison.baseline != 0) {
+            std::cout << 100 * (comparison.current - comparison.baseline) / comparison.baseline << "%";
+        } else {
+            std::cout << "-" << " ";
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << (comparison.regression ? "  REGRESSION: " : "  ") << comparison.note << std::endl;
+    }
+
+    std::cout << std::endl << "- " << comparisons.size() << " metrics compared, " << regressions << " regressed"
+              << std::endl;
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+//
+// Run time of the linear topological sort compared to the std::set based
+// sort BenchParser used before, and check that both yield the same order
+//
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchTokenizer.hpp"
+#include "Circuit.hpp"
+#include "../MappedFile.hpp"
+
+namespace {
+
+    /* Reference: the circuit node and Kahn's algorithm BenchParser used before */
+    struct legacy_node_t {
+        size_t id;
+        std::string label;
+        std::string gate_type;
+        std::set<size_t> input_id_list;
+        std::set<size_t> output_id_list;
+    };
+
+    class LegacySort {
+    public:
+        explicit LegacySort(const Circuit &circuit) {
+            for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+                legacy_node_t node{gate, std::string(circuit.Label(gate)), GateTypeName(circuit.Type(gate)), {}, {}};
+                node.input_id_list.insert(circuit.Fanins(gate).begin(), circuit.Fanins(gate).end());
+                node.output_id_list.insert(circuit.Fanouts(gate).begin(), circuit.Fanouts(gate).end());
+                id_to_circuit_node.emplace(gate, node);
+            }
+            output_circuits.insert(circuit.Outputs().begin(), circuit.Outputs().end());
+        }
+
+        /* Sorts a copy of the circuit, as the sort consumes the fanout sets */
+        std::list<legacy_node_t> Sort() const {
+            std::unordered_map<size_t, legacy_node_t> circuit = id_to_circuit_node;
+            std::set<size_t> nodes_without_outgoing_edges = output_circuits;
+            std::list<legacy_node_t> sorted_circuit;
+
+            while (!nodes_without_outgoing_edges.empty()) {
+                auto it = nodes_without_outgoing_edges.begin();
+                legacy_node_t node = circuit.at(*it);
+                nodes_without_outgoing_edges.erase(it);
+
+                sorted_circuit.push_front(node);
+                for (size_t input : node.input_id_list) {
+                    auto &fanouts = circuit.at(input).output_id_list;
+                    fanouts.erase(fanouts.find(node.id));
+                    if (fanouts.empty()) {
+                        nodes_without_outgoing_edges.insert(input);
+                    }
+                }
+            }
+            /* GetSortedCircuit returned the list by value */
+            return sorted_circuit;
+        }
+
+    private:
+        std::unordered_map<size_t, legacy_node_t> id_to_circuit_node;
+        std::set<size_t> output_circuits;
+    };
+
+    Circuit ReadCircuit(const std::string &bench_file) {
+        MappedFile file(bench_file);
+        CircuitBuilder builder;
+        for (const auto &statement : TokenizeBench(file.begin(), file.end(), builder.Symbols())) {
+            gate_type_t type;
+            if (!ParseGateType(statement.gate_type, type)) {
+                throw bench_syntax_error(statement.line, "unknown gate type " + std::string(statement.gate_type));
+            }
+            if (type == gate_type_t::Input) {
+                builder.AddInput(statement.label);
+            } else if (type == gate_type_t::Output) {
+                builder.AddOutput(statement.label);
+            } else {
+                builder.AddGate(statement.label, type, statement.inputs);
+            }
+        }
+        return builder.Build();
+    }
+
+    template<typename Sort>
+    double BestTime(Sort sort, int repeat) {
+        double best = 0;
+        for (int i = 0; i < repeat; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            sort();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (i == 0 || elapsed.count() < best) {
+                best = elapsed.count();
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    int repeat = 20;
+    std::vector<std::string> bench_files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::stoi(argv[++i]);
+        } else {
+            bench_files.push_back(arg);
+        }
+    }
+
+    if (bench_files.empty() || repeat < 1) {
+        std::cout << "Usage: " << argv[0] << " [--repeat N] <file.bench>..." << std::endl;
+        return -1;
+    }
+
+    std::cout << std::left << std::setw(28) << "file" << std::right << std::setw(10) << "gates"
+              << std::setw(10) << "edges" << std::setw(14) << "linear us" << std::setw(14) << "std::set us"
+              << std::setw(10) << "speedup" << std::setw(12) << "same order" << std::endl;
+
+    bool all_equal = true;
+    for (const auto &bench_file : bench_files) {
+        Circuit circuit = ReadCircuit(bench_file);
+        LegacySort legacy(circuit);
+
+        size_t edges = 0;
+        for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+            edges += circuit.Fanins(gate).size();
+        }
+
+        std::vector<gate_t> order;
+        std::list<legacy_node_t> legacy_order;
+        double linear_time = BestTime([&]() { order = TopologicalOrder(circuit); }, repeat);
+        double legacy_time = BestTime([&]() { legacy_order = legacy.Sort(); }, repeat);
+
+        bool equal = order.size() == legacy_order.size();
+        auto legacy_node = legacy_order.begin();
+        for (size_t i = 0; equal && i < order.size(); ++i, ++legacy_node) {
+            equal = order[i] == legacy_node->id;
+        }
+        all_equal = all_equal && equal;
+
+        std::cout << std::left << std::setw(28) << std::filesystem::path(bench_file).filename().string() << std::right
+                  << std::setw(10) << circuit.Size() << std::setw(10) << edges
+                  << std::setw(14) << std::fixed << std::setprecision(1) << linear_time * 1e6
+                  << std::setw(14) << legacy_time * 1e6 << std::setw(9) << legacy_time / linear_time << "x"
+                  << std::setw(12) << (equal ? "yes" : "NO") << std::endl;
+    }
+
+    return all_equal ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+//
+// Runs VDSProject_bench's stages over a set of circuits and writes the measurements as JSON and CSV
+//
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Manager.h"
+#include "BenchParser.hpp"
+#include "CircuitToBDD.hpp"
+#include "BenchmarkLib.h"
+#include "SuiteResults.hpp"
+
+namespace {
+    /* Runs all stages in this process, which is a fresh child of the suite */
+    run_record_t MeasureRun(const std::string &bench_file, decomposition_t decomposition) {
+        run_record_t record;
+        BenchParser parser(bench_file);
+        record.parse = parser.GetParseTime();
+        record.sort = parser.GetSortTime();
+        record.gates = parser.GetCircuit().Size();
+
+        auto manager = std::make_shared<ClassProject::Manager>();
+        CircuitToBDD circuit_to_bdd(manager);
+        circuit_to_bdd.SetDecomposition(decomposition);
+        StageTimer build_timer;
+        circuit_to_bdd.GenerateBDD(parser.GetCircuit(), parser.GetSortedCircuit(), bench_file);
+        record.build = build_timer.Elapsed();
+        record.nodes = manager->liveNodeCount();
+        record.peak_live_nodes = manager->peakLiveNodeCount();
+        record.cache = manager->cacheStatistics();
+
+        std::set<label_t> output_labels = parser.GetListOfOutputLabels();
+        StageTimer dump_timer;
+        circuit_to_bdd.PrintBDD(output_labels);
+        record.dump = dump_timer.Elapsed();
+
+        std::vector<ClassProject::BDD_ID> roots;
+        for (const auto &output : circuit_to_bdd.GetOutputBDDs(output_labels)) {
+            roots.push_back(output.second);
+        }
+        record.output_nodes = manager->analyzeRoots(roots).sharedNodeCount;
+        record.status = run_status_t::Ok;
+        return record;
+    }
+
+    /* Forks a child for one run, so that every run starts from a fresh heap and its peak RSS is its own */
+    run_record_t ForkRun(const std::string &bench_file, decomposition_t decomposition, unsigned timeout) {
+        /* The child dumps into a fresh directory, so that no run overwrites the dumps of an earlier one */
+        std::string work_dir = (std::filesystem::temp_directory_path() / "vds_suite_XXXXXX").string();
+        if (mkdtemp(work_dir.data()) == nullptr) {
+            throw std::runtime_error("Unable to create a directory: " + std::string(std::strerror(errno)));
+        }
+        std::string bench_path = std::filesystem::absolute(bench_file).string();
+
+        int channel[2];
+        if (pipe(channel) != 0) {
+            throw std::runtime_error("Unable to create a pipe: " + std::string(std::strerror(errno)));
+        }
+        std::cout.flush();
+        pid_t child = fork();
+        if (child < 0) {
+            throw std::runtime_error("Unable to fork: " + std::string(std::strerror(errno)));
+        }
+        if (child == 0) {
+            close(channel[0]);
+            /* The stages report their progress on stdout; only errors are kept */
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+            alarm(timeout);
+            run_record_t record;
+            try {
+                if (chdir(work_dir.c_str()) != 0) {
+                    throw std::runtime_error("Unable to enter " + work_dir + ": " + std::strerror(errno));
+                }
+                record = MeasureRun(bench_path, decomposition);
+            } catch (const std::exception &error) {
+                std::cerr << bench_file << ": " << error.what() << std::endl;
+            }
+            ssize_t written = write(channel[1], &record, sizeof(record));
+            _exit(written == sizeof(record) ? 0 : 1);
+        }
+
+        close(channel[1]);
+        run_record_t record;
+        ssize_t received = read(channel[0], &record, sizeof(record));
+        close(channel[0]);
+        int status = 0;
+        struct rusage usage{};
+        wait4(child, &status, 0, &usage);
+        std::error_code ignored;
+        std::filesystem::remove_all(work_dir, ignored);
+        if (received != sizeof(record)) {
+            record = run_record_t();
+            record.status = WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM ? run_status_t::Timeout
+                                                                              : run_status_t::Failed;
+        }
+        record.peak_rss_kb = usage.ru_maxrss;
+        return record;
+    }
+
+    double Median(std::vector<double> values) {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    unsigned repetitions = 5;
+    unsigned timeout = 300;
+    decomposition_t decomposition = decomposition_t::Linear;
+    std::string json_file = "benchmark_suite.json";
+    std::string csv_file;
+    std::vector<std::string> bench_files;
+    auto usage = [&]() {
+        std::cout << "Usage: " << argv[0] << " [--repeat N] [--timeout <seconds>] [--json <file>] [--csv <file>]"
+                  << " [--decompose linear|balanced|greedy] [<circuit>...]" << std::endl;
+        std::cout << "  Without circuits, every .bench file of benchmarks/iscas85 is run. N must be at least 1."
+                  << std::endl;
+        return -1;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--repeat" && i + 1 < argc) {
+                repetitions = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--timeout" && i + 1 < argc) {
+                timeout = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--json" && i + 1 < argc) {
+                json_file = argv[++i];
+            } else if (arg == "--csv" && i + 1 < argc) {
+                csv_file = argv[++i];
+            } else if (arg == "--decompose" && i + 1 < argc) {
+                if (!ParseDecomposition(argv[++i], decomposition)) {
+                    std::cout << "Unknown decomposition strategy: " << argv[i] << std::endl;
+                    return -1;
+                }
+            } else if (arg.rfind("--", 0) == 0) {
+                return usage();
+            } else {
+                bench_files.push_back(arg);
+            }
+        } catch (const std::logic_error &) {
+            /* std::stoul throws std::invalid_argument or std::out_of_range */
+            return usage();
+        }
+    }
+    if (repetitions == 0) {
+        return usage();
+    }
+
+    if (bench_files.empty()) {
+        std::string suite_dir = "benchmarks/iscas85";
+        if (!std::filesystem::is_directory(suite_dir)) {
+            std::cout << "No circuits given and " << suite_dir << " not found" << std::endl;
+            return -1;
+        }
+        for (const auto &entry : std::filesystem::directory_iterator(suite_dir)) {
+            if (entry.path().extension() == ".bench") {
+                bench_files.push_back(entry.path().string());
+            }
+        }
+        std::sort(bench_files.begin(), bench_files.end());
+    }
+
+    suite_results_t results{repetitions, decomposition, {}};
+    int exit_code = 0;
+    std::cout << std::left << std::setw(12) << "circuit" << std::right << std::setw(10) << "parse" << std::setw(10)
+              << "build" << std::setw(10) << "dump" << std::setw(12) << "RSS [MB]" << std::setw(12) << "nodes"
+              << std::setw(10) << "hit rate" << "  (medians of wall seconds)" << std::endl;
+    for (const auto &bench_file : bench_files) {
+        circuit_runs_t circuit{std::filesystem::path(bench_file).stem().string(), bench_file, {}};
+        std::vector<double> parse, build, dump, rss;
+        for (unsigned repetition = 0; repetition < repetitions; ++repetition) {
+            run_record_t run = ForkRun(bench_file, decomposition, timeout);
+            circuit.runs.push_back(run);
+            if (run.status != run_status_t::Ok) {
+                exit_code = 1;
+                break;
+            }
+            parse.push_back(run.parse.wall + run.sort.wall);
+            build.push_back(run.build.wall);
+            dump.push_back(run.dump.wall);
+            rss.push_back(static_cast<double>(run.peak_rss_kb) / 1024);
+        }
+
+        const run_record_t &last = circuit.runs.back();
+        std::cout << std::left << std::setw(12) << circuit.name << std::right << std::fixed << std::setprecision(3);
+        if (last.status == run_status_t::Ok) {
+            double hit_rate = last.cache.computedLookups
+                              ? static_cast<double>(last.cache.computedHits) /
+                                static_cast<double>(last.cache.computedLookups) : 0;
+            std::cout << std::setw(10) << Median(parse) << std::setw(10) << Median(build) << std::setw(10)
+                      << Median(dump) << std::setw(12) << std::setprecision(1) << Median(rss) << std::setw(12)
+                      << last.nodes << std::setw(10) << std::setprecision(3) << hit_rate << std::endl;
+        } else {
+            std::cout << "  " << RunStatusName(last.status) << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        results.circuits.push_back(std::move(circuit));
+    }
+
+    WriteSuiteJson(json_file, results);
+    std::cout << std::endl << "- Results written to " << json_file;
+    if (!csv_file.empty()) {
+        WriteSuiteCsv(csv_file, results);
+        std::cout << " and " << csv_file;
+    }
+    std::cout << std::endl;
+    return exit_code;
+}
@@ -0,0 +1,1072 @@
+/**
+ * @file bench_test.cpp
+ * @brief Unit tests for the bench file front-end using Google Test.
+ */
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../bench/AigerReader.hpp"
+#include "../bench/BenchTokenizer.hpp"
+#include "../bench/BlifReader.hpp"
+#include "../bench/Circuit.hpp"
+#include "../bench/CircuitOptimizer.hpp"
+#include "../bench/CircuitSimulator.hpp"
+#include "../bench/CircuitToBDD.hpp"
+#include "../bench/ResultCache.hpp"
+#include "../bench/SuiteResults.hpp"
+#include "../Manager.h"
+#include "../verify/VerifyLib.h"
+
+namespace {
+    std::vector<bench_statement_t> Tokenize(const std::string &text, SymbolTable &symbols) {
+        BenchTokenizer tokenizer(text.data(), text.data() + text.size(), symbols);
+        std::vector<bench_statement_t> statements;
+        bench_statement_t statement;
+        while (tokenizer.Next(statement)) {
+            statements.push_back(statement);
+        }
+        return statements;
+    }
+
+    std::string WriteFile(const std::string &name, const std::string &content) {
+        std::string path = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+
+    /* Values of the outputs of a combinational circuit under the given input values */
+    std::map<std::string, bool> Simulate(const Circuit &circuit, const std::map<std::string, bool> &inputs) {
+        std::vector<bool> value(circuit.Size());
+        std::map<std::string, bool> outputs;
+        for (gate_t gate : TopologicalOrder(circuit)) {
+            gate_range_t fanins = circuit.Fanins(gate);
+            bool all = true, any = false, parity = false;
+            for (gate_t fanin : fanins) {
+                all = all && value[fanin];
+                any = any || value[fanin];
+                parity = parity != value[fanin];
+            }
+            switch (circuit.Type(gate)) {
+                case gate_type_t::Input: value[gate] = inputs.at(std::string(circuit.Label(gate))); break;
+                case gate_type_t::Output: outputs[std::string(circuit.Label(gate))] = value[gate] = all; break;
+                case gate_type_t::Buff: case gate_type_t::And: value[gate] = all; break;
+                case gate_type_t::Not: case gate_type_t::Nand: value[gate] = !all; break;
+                case gate_type_t::Or: value[gate] = any; break;
+                case gate_type_t::Nor: value[gate] = !any; break;
+                case gate_type_t::Xor: value[gate] = parity; break;
+                case gate_type_t::Const0: value[gate] = false; break;
+                case gate_type_t::Const1: value[gate] = true; break;
+                case gate_type_t::Dff: break;
+            }
+        }
+        return outputs;
+    }
+
+    /* A ripple-carry adder of two numbers a and b with sum s and carry out c<bits - 1> */
+    std::string AdderBench(unsigned bits) {
+        std::string text;
+        for (unsigned i = 0; i < bits; ++i) {
+            text += "INPUT(a" + std::to_string(i) + ")\nINPUT(b" + std::to_string(i) + ")\n";
+        }
+        for (unsigned i = 0; i < bits; ++i) {
+            text += "OUTPUT(s" + std::to_string(i) + ")\n";
+        }
+        text += "OUTPUT(c" + std::to_string(bits - 1) + ")\n";
+        text += "c0 = AND(a0, b0)\ns0 = XOR(a0, b0)\n";
+        for (unsigned i = 1; i < bits; ++i) {
+            std::string n = std::to_string(i), carry = "c" + std::to_string(i - 1);
+            text += "h" + n + " = XOR(a" + n + ", b" + n + ")\n";
+            text += "s" + n + " = XOR(h" + n + ", " + carry + ")\n";
+            text += "g" + n + " = AND(a" + n + ", b" + n + ")\n";
+            text += "p" + n + " = AND(h" + n + ", " + carry + ")\n";
+            text += "c" + n + " = OR(g" + n + ", p" + n + ")\n";
+        }
+        return text;
+    }
+
+    /* An array multiplier of two numbers a and b with product m, from half and full adders */
+    std::string MultiplierBench(unsigned bits) {
+        std::string text, gates;
+        unsigned next = 0;
+        auto gate = [&](const std::string &type, const std::string &x, const std::string &y) {
+            std::string label = "t" + std::to_string(next++);
+            gates += label + " = " + type + "(" + x + ", " + y + ")\n";
+            return label;
+        };
+        for (unsigned i = 0; i < bits; ++i) {
+            text += "INPUT(a" + std::to_string(i) + ")\nINPUT(b" + std::to_string(i) + ")\n";
+        }
+
+        /* The sum so far, one label per weight, empty while zero; adds a label and a carry at one weight */
+        std::vector<std::string> sum(2 * bits);
+        auto add = [&](unsigned weight, const std::string &y, std::string &carry) {
+            std::vector<std::string> operands;
+            for (const auto &operand : {sum[weight], y, carry}) {
+                if (!operand.empty()) operands.push_back(operand);
+            }
+            carry.clear();
+            if (operands.size() == 1) {
+                sum[weight] = operands[0];
+            } else if (operands.size() == 2) {
+                sum[weight] = gate("XOR", operands[0], operands[1]);
+                carry = gate("AND", operands[0], operands[1]);
+            } else if (operands.size() == 3) {
+                std::string half = gate("XOR", operands[0], operands[1]);
+                sum[weight] = gate("XOR", half, operands[2]);
+                carry = gate("OR", gate("AND", operands[0], operands[1]), gate("AND", half, operands[2]));
+            }
+        };
+        for (unsigned i = 0; i < bits; ++i) {
+            std::string carry;
+            for (unsigned j = 0; j < bits; ++j) {
+                add(i + j, gate("AND", "a" + std::to_string(j), "b" + std::to_string(i)), carry);
+            }
+            for (unsigned weight = i + bits; !carry.empty() && weight < 2 * bits; ++weight) {
+                add(weight, "", carry);
+            }
+        }
+        for (unsigned k = 0; k < 2 * bits; ++k) {
+            text += "OUTPUT(m" + std::to_string(k) + ")\n";
+            gates += "m" + std::to_string(k) + " = BUFF(" + sum[k] + ")\n";
+        }
+        return text + gates;
+    }
+
+    /* Value of f when every variable takes the value of the input it is named after */
+    bool Evaluate(ClassProject::ManagerInterface &manager, ClassProject::BDD_ID f,
+                  const std::map<std::string, bool> &inputs) {
+        while (!manager.isConstant(f)) {
+            f = inputs.at(manager.getTopVarName(f)) ? manager.coFactorTrue(f) : manager.coFactorFalse(f);
+        }
+        return f == manager.True();
+    }
+
+    /* Compares two sets of output BDDs, possibly of different managers, under every assignment of the inputs */
+    void ExpectSameFunctions(ClassProject::ManagerInterface &expected_manager,
+                             const std::map<label_t, ClassProject::BDD_ID> &expected,
+                             ClassProject::ManagerInterface &actual_manager,
+                             const std::map<label_t, ClassProject::BDD_ID> &actual, const Circuit &circuit) {
+        std::vector<std::string> inputs;
+        for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+            if (circuit.Type(gate) == gate_type_t::Input) inputs.emplace_back(circuit.Label(gate));
+        }
+        ASSERT_LE(inputs.size(), 16u);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (uint32_t bits = 0; bits < (1u << inputs.size()); ++bits) {
+            std::map<std::string, bool> values;
+            for (size_t i = 0; i < inputs.size(); ++i) values[inputs[i]] = (bits >> i) & 1;
+            for (const auto &output : expected) {
+                ASSERT_TRUE(actual.count(output.first)) << output.first;
+                EXPECT_EQ(Evaluate(actual_manager, actual.at(output.first), values),
+                          Evaluate(expected_manager, output.second, values)) << output.first << " at " << bits;
+            }
+        }
+    }
+
+    /* Builds before, then after incrementally from the checkpoint of before, as main_bench --incremental does.
+       Expects exactly the gates of rebuilt to be invalidated and the outputs of a full build of after. */
+    void ExpectIncrementalRebuild(const std::string &before, const std::string &after,
+                                  const std::set<std::string> &rebuilt) {
+        std::string before_path = WriteFile("vds_eco_before.bench", before);
+        std::string after_path = WriteFile("vds_eco_after.bench", after);
+        std::string state = (std::filesystem::temp_directory_path() / "vds_eco").string();
+        {
+            BenchParser parser(before_path);
+            auto manager = std::make_shared<ClassProject::Manager>();
+            CircuitToBDD circuit_to_bdd(manager);
+            circuit_to_bdd.GenerateBDD(parser.GetCircuit(), parser.GetSortedCircuit(), before_path);
+            manager->checkpoint(state + ".ckpt", true);
+            circuit_to_bdd.SaveGateMap(state + ".gates");
+            CircuitToBDD::SaveCircuitSignature(parser.GetCircuit(), parser.GetSortedCircuit(), state + ".sig");
+        }
+
+        BenchParser parser(after_path);
+        const Circuit &circuit = parser.GetCircuit();
+        auto manager = std::make_shared<ClassProject::Manager>();
+        manager->restore(state + ".ckpt");
+        CircuitToBDD incremental(manager);
+        incremental.RestoreGateMap(state + ".gates", manager->uniqueTableSize());
+        size_t to_build = incremental.InvalidateChangedGates(circuit, parser.GetSortedCircuit(), state + ".sig");
+
+        /* The gates left without a BDD are the ones GenerateBDD builds; gates that no longer exist are dropped */
+        incremental.SaveGateMap(state + ".gates");
+        std::set<std::string> kept, missing;
+        std::ifstream gate_map(state + ".gates");
+        std::string line;
+        std::getline(gate_map, line);
+        while (std::getline(gate_map, line)) {
+            kept.insert(line.substr(line.find(',') + 1));
+        }
+        std::set<std::string> labels;
+        for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+            if (circuit.Type(gate) == gate_type_t::Output) continue;
+            labels.emplace(circuit.Label(gate));
+            if (!kept.count(std::string(circuit.Label(gate)))) missing.emplace(circuit.Label(gate));
+        }
+        for (const auto &label : kept) {
+            EXPECT_TRUE(labels.count(label)) << label;
+        }
+        EXPECT_EQ(missing, rebuilt);
+        EXPECT_EQ(to_build, rebuilt.size());
+
+        incremental.GenerateBDD(circuit, parser.GetSortedCircuit(), after_path);
+        auto full_manager = std::make_shared<ClassProject::Manager>();
+        CircuitToBDD full(full_manager);
+        full.GenerateBDD(circuit, parser.GetSortedCircuit(), after_path);
+        ExpectSameFunctions(*full_manager, full.GetOutputBDDs(parser.GetListOfOutputLabels()), *manager,
+                            incremental.GetOutputBDDs(parser.GetListOfOutputLabels()), circuit);
+
+        for (const auto &path : {before_path, after_path}) {
+            std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+            std::filesystem::remove(path);
+        }
+        for (const char *suffix : {".ckpt", ".gates", ".sig"}) {
+            std::filesystem::remove(state + suffix);
+        }
+    }
+}
+
+// ======== Bench Tokenizer ========
+TEST(BenchTokenizerTest, ReadsDeclarationsAndGates) {
+    /* gate_type views into the text, which must outlive the statements */
+    std::string text = "# c17\n"
+                       "INPUT(1)\n"
+                       "INPUT(2)\n"
+                       "\n"
+                       "OUTPUT(22)\n"
+                       "10 = NAND(1, 2)\n"
+                       "22\t=  NOT(10)";
+    SymbolTable symbols;
+    auto statements = Tokenize(text, symbols);
+
+    ASSERT_EQ(statements.size(), 5);
+    EXPECT_EQ(statements[0].gate_type, "INPUT");
+    EXPECT_EQ(symbols.Name(statements[0].label), "1");
+    EXPECT_EQ(statements[2].gate_type, "OUTPUT");
+    EXPECT_EQ(statements[3].gate_type, "NAND");
+    EXPECT_EQ(statements[3].line, 6);
+    ASSERT_EQ(statements[3].inputs.size(), 2);
+    EXPECT_EQ(statements[3].inputs[0], statements[0].label);
+    EXPECT_EQ(statements[4].inputs[0], statements[3].label);
+    EXPECT_EQ(statements[2].label, statements[4].label);
+    EXPECT_EQ(symbols.Size(), 4);
+}
+
+TEST(BenchTokenizerTest, RejectsWhatTheGrammarRejects) {
+    SymbolTable symbols;
+    EXPECT_THROW(Tokenize("10 = AND(1)\n", symbols), std::runtime_error);
+    EXPECT_THROW(Tokenize("10 = NOT(1, 2)\n", symbols), std::runtime_error);
+    EXPECT_THROW(Tokenize("10 = MUX(1, 2)\n", symbols), std::runtime_error);
+    EXPECT_THROW(Tokenize("INPUT(1) INPUT(2)\n", symbols), std::runtime_error);
+    EXPECT_THROW(Tokenize("10 = AND(1, 2\n", symbols), std::runtime_error);
+}
+
+TEST(BenchTokenizerTest, SymbolTableInternsOnce) {
+    SymbolTable symbols;
+    std::string label = "G42.out";
+    symbol_t first = symbols.Intern(label);
+    label[0] = 'X';
+    EXPECT_EQ(symbols.Intern("G42.out"), first);
+    EXPECT_EQ(symbols.Name(first), "G42.out");
+
+    symbol_t found;
+    EXPECT_TRUE(symbols.Find("G42.out", found));
+    EXPECT_EQ(found, first);
+    EXPECT_FALSE(symbols.Find("X42.out", found));
+}
+
+TEST(BenchTokenizerTest, ChunkedTokenizingMatchesSequential) {
+    /* Large enough to be split across threads; every gate refers back to
+       labels that may be defined in an earlier chunk */
+    for (std::string newline : {"\n", "\r\n", "\r"}) {
+        SCOPED_TRACE(newline == "\n" ? "LF" : newline == "\r" ? "CR" : "CRLF");
+        std::string text = "INPUT(a)" + newline + "INPUT(b)" + newline;
+        for (int i = 0; i < 200000; ++i) {
+            std::string previous = i == 0 ? "a" : "n" + std::to_string(i - 1);
+            text += "n" + std::to_string(i) + " = AND(" + previous + ", b)" + newline;
+        }
+
+        SymbolTable sequential_symbols, chunked_symbols;
+        auto sequential = Tokenize(text, sequential_symbols);
+        auto chunked = TokenizeBench(text.data(), text.data() + text.size(), chunked_symbols, 4);
+
+        ASSERT_EQ(chunked.size(), sequential.size());
+        EXPECT_EQ(chunked_symbols.Size(), sequential_symbols.Size());
+        for (size_t i = 3; i < chunked.size(); ++i) {
+            ASSERT_EQ(chunked[i].line, sequential[i].line);
+            ASSERT_EQ(chunked_symbols.Name(chunked[i].label), sequential_symbols.Name(sequential[i].label));
+            ASSERT_EQ(chunked[i].inputs.size(), 2);
+            ASSERT_EQ(chunked[i].inputs[0], chunked[i - 1].label);
+        }
+
+        /* Errors deep in a later chunk report their line in the whole text */
+        text += "broken = AND(a)" + newline;
+        try {
+            TokenizeBench(text.data(), text.data() + text.size(), chunked_symbols, 4);
+            FAIL() << "syntax error not reported";
+        } catch (const bench_syntax_error &error) {
+            EXPECT_EQ(error.line, 200003);
+        }
+    }
+}
+
+// ======== Circuit ========
+TEST(CircuitTest, BuilderNumbersGatesFromTheOutputs) {
+    /* s is a flip flop: its current state is an input, its next state reads g */
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+    symbol_t a = symbols.Intern("a"), b = symbols.Intern("b"), g = symbols.Intern("g");
+    symbol_t s = symbols.Intern("s"), z = symbols.Intern("z"), unused = symbols.Intern("unused");
+    builder.AddOutput(z);
+    builder.AddGate(z, gate_type_t::Nand, {g, a, g});
+    builder.AddGate(g, gate_type_t::Or, {b, s});
+    builder.AddGate(s, gate_type_t::Dff, {g});
+    builder.AddGate(unused, gate_type_t::Not, {a});
+    builder.AddInput(a);
+    builder.AddInput(b);
+    Circuit circuit = builder.Build();
+
+    /* OUTPUT z, z, g, b, s (state), a, DFF s; the unused gate is dropped */
+    ASSERT_EQ(circuit.Size(), 7);
+    EXPECT_EQ(circuit.Type(0), gate_type_t::Output);
+    EXPECT_EQ(circuit.Label(1), "z");
+    EXPECT_EQ(circuit.Label(2), "g");
+    EXPECT_EQ(circuit.Type(4), gate_type_t::Input);
+    EXPECT_EQ(circuit.Label(4), "s");
+    EXPECT_EQ(circuit.Type(6), gate_type_t::Dff);
+    EXPECT_EQ(circuit.Outputs(), std::vector<gate_t>({0, 6}));
+
+    std::vector<gate_t> z_fanins(circuit.Fanins(1).begin(), circuit.Fanins(1).end());
+    EXPECT_EQ(z_fanins, std::vector<gate_t>({2, 5}));
+    std::vector<gate_t> g_fanouts(circuit.Fanouts(2).begin(), circuit.Fanouts(2).end());
+    EXPECT_EQ(g_fanouts, std::vector<gate_t>({1, 6}));
+    EXPECT_TRUE(circuit.Fanins(5).empty());
+}
+
+TEST(CircuitTest, BuilderRejectsUndefinedLabels) {
+    CircuitBuilder builder;
+    symbol_t z = builder.Symbols().Intern("z");
+    builder.AddOutput(z);
+    builder.AddGate(z, gate_type_t::Not, {builder.Symbols().Intern("missing")});
+    EXPECT_THROW(builder.Build(), std::runtime_error);
+}
+
+TEST(CircuitTest, TopologicalOrderPutsFaninsFirst) {
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+    symbol_t a = symbols.Intern("a"), b = symbols.Intern("b"), c = symbols.Intern("c");
+    symbol_t x = symbols.Intern("x"), y = symbols.Intern("y");
+    builder.AddOutput(x);
+    builder.AddOutput(y);
+    builder.AddGate(x, gate_type_t::And, {a, c});
+    builder.AddGate(y, gate_type_t::Xor, {c, b});
+    builder.AddGate(c, gate_type_t::Or, {a, b});
+    builder.AddInput(a);
+    builder.AddInput(b);
+    Circuit circuit = builder.Build();
+
+    std::vector<gate_t> order = TopologicalOrder(circuit);
+    ASSERT_EQ(order.size(), circuit.Size());
+    std::vector<size_t> position(circuit.Size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        position[order[i]] = i;
+    }
+    for (gate_t gate = 0; gate < circuit.Size(); ++gate) {
+        for (gate_t fanin : circuit.Fanins(gate)) {
+            EXPECT_LT(position[fanin], position[gate]);
+        }
+    }
+
+    CircuitBuilder cyclic;
+    symbol_t p = cyclic.Symbols().Intern("p"), q = cyclic.Symbols().Intern("q");
+    cyclic.AddOutput(p);
+    cyclic.AddGate(p, gate_type_t::Not, {q});
+    cyclic.AddGate(q, gate_type_t::Not, {p});
+    EXPECT_THROW(TopologicalOrder(cyclic.Build()), std::runtime_error);
+}
+
+TEST(CircuitTest, OptimizerKeepsTheOutputFunctions) {
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+    auto gate = [&](const char *label, gate_type_t type, std::vector<const char *> inputs) {
+        std::vector<symbol_t> input_symbols;
+        for (const char *input : inputs) {
+            input_symbols.push_back(symbols.Intern(input));
+        }
+        builder.AddGate(symbols.Intern(label), type, input_symbols);
+    };
+    for (const char *input : {"a", "b", "c"}) {
+        builder.AddInput(symbols.Intern(input));
+    }
+    gate("g1", gate_type_t::And, {"a", "b"});
+    gate("g2", gate_type_t::And, {"b", "a"});           // same as g1
+    gate("n1", gate_type_t::Not, {"a"});
+    gate("n2", gate_type_t::Not, {"n1"});               // a
+    gate("buf", gate_type_t::Buff, {"n2"});             // a
+    gate("k0", gate_type_t::Const0, {});
+    gate("k1", gate_type_t::Const1, {});
+    gate("x", gate_type_t::Or, {"g1", "k0"});           // g1
+    gate("y", gate_type_t::Nand, {"g2", "k1"});         // NOT g1
+    gate("z", gate_type_t::Xor, {"buf", "a", "k1"});    // 1
+    gate("w", gate_type_t::Xor, {"c", "b", "k1"});      // XNOR
+    gate("v", gate_type_t::And, {"g1", "k0"});          // 0
+    for (const char *output : {"x", "y", "z", "w", "v", "buf"}) {
+        builder.AddOutput(symbols.Intern(output));
+    }
+    Circuit circuit = builder.Build();
+
+    optimize_stats_t stats;
+    Circuit optimized = OptimizeCircuit(circuit, TopologicalOrder(circuit), stats);
+    EXPECT_EQ(stats.operations_before, 9);
+    EXPECT_EQ(stats.operations_after, 3);
+    EXPECT_EQ(stats.merged, 1);
+    EXPECT_EQ(stats.bypassed, 3);
+    EXPECT_EQ(stats.constants, 2);
+
+    for (int a = 0; a < 2; ++a) {
+        for (int b = 0; b < 2; ++b) {
+            for (int c = 0; c < 2; ++c) {
+                std::map<std::string, bool> inputs = {{"a", a}, {"b", b}, {"c", c}};
+                EXPECT_EQ(Simulate(optimized, inputs), Simulate(circuit, inputs));
+            }
+        }
+    }
+}
+
+TEST(CircuitTest, SimulatorEstimatesSignalStatistics) {
+    CircuitBuilder builder;
+    SymbolTable &symbols = builder.Symbols();
+    symbol_t a = symbols.Intern("a"), b = symbols.Intern("b"), x = symbols.Intern("x"), y = symbols.Intern("y");
+    builder.AddInput(a);
+    builder.AddInput(b);
+    builder.AddGate(x, gate_type_t::And, {a, b});
+    builder.AddGate(y, gate_type_t::Xor, {a, b});
+    builder.AddOutput(x);
+    builder.AddOutput(y);
+    Circuit circuit = builder.Build();
+    std::vector<gate_t> order = TopologicalOrder(circuit);
+    gate_t and_gate = circuit.Fanins(circuit.Outputs()[0])[0];
+    gate_t xor_gate = circuit.Fanins(circuit.Outputs()[1])[0];
+    gate_t input = circuit.Fanins(and_gate)[0];
+
+    EXPECT_THROW(CircuitSimulator(circuit, order, 3), std::invalid_argument);
+    CircuitSimulator simulator(circuit, order, 4);
+    simulator.Run(64, 1);
+    ASSERT_EQ(simulator.Patterns(), 64 * 256);
+    EXPECT_NEAR(simulator.SignalProbability(and_gate), 0.25, 0.02);
+    EXPECT_NEAR(simulator.SignalProbability(xor_gate), 0.5, 0.02);
+    EXPECT_NEAR(simulator.ToggleRate(input), 0.5, 0.02);
+    EXPECT_NEAR(simulator.ToggleRate(and_gate), 2 * 0.25 * 0.75, 0.02);
+    for (size_t pattern = 0; pattern < simulator.PatternsPerPass(); ++pattern) {
+        bool first = simulator.Value(circuit.Fanins(and_gate)[0], pattern);
+        bool second = simulator.Value(circuit.Fanins(and_gate)[1], pattern);
+        EXPECT_EQ(simulator.Value(and_gate, pattern), first && second);
+        EXPECT_EQ(simulator.Value(xor_gate, pattern), first != second);
+    }
+
+    ClassProject::Manager manager;
+    ClassProject::BDD_ID var_a = manager.createVar("a"), var_b = manager.createVar("b");
+    EXPECT_EQ(simulator.CheckBDDs(manager, {{"x", manager.and2(var_a, var_b)}, {"y", manager.xor2(var_a, var_b)}}), 0);
+    EXPECT_GT(simulator.CheckBDDs(manager, {{"x", manager.or2(var_a, var_b)}}), 0);
+}
+
+// ======== AIGER and BLIF readers ========
+TEST(NetlistReaderTest, AsciiAndBinaryAigerAgree) {
+    /* f = !(a & !b) */
+    std::string ascii = WriteFile("vds_reader_test.aag", "aag 3 2 0 1 1\n2\n4\n7\n6 2 5\ni0 a\ni1 b\no0 f\nc\nnot part of the graph\n");
+    std::string binary = WriteFile("vds_reader_test.aig", std::string("aig 3 2 0 1 1\n7\n\x01\x03i0 a\ni1 b\no0 f\n"));
+
+    for (const auto &path : {ascii, binary}) {
+        Circuit circuit = AigerReader::Read(path);
+        for (int a = 0; a < 2; ++a) {
+            for (int b = 0; b < 2; ++b) {
+                EXPECT_EQ(Simulate(circuit, {{"a", a}, {"b", b}}).at("f"), !(a && !b)) << path;
+            }
+        }
+    }
+    EXPECT_THROW(AigerReader::Read(WriteFile("vds_reader_test.aag", "aag 1 1 0 1 0\n2\n4\n")), std::runtime_error);
+}
+
+TEST(NetlistReaderTest, AigerRejectsLabelCollisions) {
+    /* f = !a is exported, and may be read several times */
+    EXPECT_NO_THROW(AigerReader::Read(WriteFile("vds_reader_test.aag", "aag 1 1 0 2 0\n2\n3\n3\ni0 a\no0 f\no1 g\n")));
+    /* An output named like an input, another output, a negation or a
+       generated AND gate label would export the wrong function */
+    for (const char *symbols : {"i0 a\no0 a\n", "i0 a\no0 f\no1 f\n", "i0 a\no0 f\no1 !a\n", "i0 a\no0 $0\n"}) {
+        std::string path = WriteFile("vds_reader_test.aag", std::string("aag 1 1 0 2 0\n2\n3\n3\n") + symbols);
+        EXPECT_THROW(AigerReader::Read(path), std::runtime_error) << symbols;
+    }
+    /* Inputs named like a generated AND gate or a latch next-state label */
+    EXPECT_NO_THROW(AigerReader::Read(WriteFile("vds_reader_test.aag", "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\ni0 a\n")));
+    EXPECT_NO_THROW(AigerReader::Read(WriteFile("vds_reader_test.aag", "aag 2 1 1 0 0\n2\n4 2\ni0 a\nl0 q\n")));
+    EXPECT_THROW(AigerReader::Read(WriteFile("vds_reader_test.aag", "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\ni0 $3\n")),
+                 std::runtime_error);
+    EXPECT_THROW(AigerReader::Read(WriteFile("vds_reader_test.aag", "aag 2 1 1 0 0\n2\n4 2\ni0 q.next\nl0 q\n")),
+                 std::runtime_error);
+}
+
+TEST(NetlistReaderTest, BlifCoversBecomeGates) {
+    std::string path = WriteFile("vds_reader_test.blif", ".model test\n"
+                                                         ".inputs a b \\\n c\n"
+                                                         ".outputs x n one\n"
+                                                         ".names a b x  # exclusive or\n10 1\n01 1\n"
+                                                         ".names a b c n\n11- 0\n"
+                                                         ".names one\n1\n"
+                                                         ".end\n");
+    Circuit circuit = BlifReader::Read(path);
+    for (int a = 0; a < 2; ++a) {
+        for (int b = 0; b < 2; ++b) {
+            auto outputs = Simulate(circuit, {{"a", a}, {"b", b}, {"c", 0}});
+            EXPECT_EQ(outputs.at("x"), a != b);
+            EXPECT_EQ(outputs.at("n"), !(a && b));
+            EXPECT_TRUE(outputs.at("one"));
+        }
+    }
+    EXPECT_THROW(BlifReader::Read(WriteFile("vds_reader_test.blif", ".model m\n.subckt x a=b\n")),
+                 std::runtime_error);
+}
+
+// ======== Circuit to BDD ========
+TEST(CircuitToBDDTest, DecompositionStrategiesBuildTheSameFunctions) {
+    std::string path = WriteFile("vds_decompose_test.bench", "INPUT(a)\nINPUT(b)\nINPUT(c)\nINPUT(d)\nINPUT(e)\n"
+                                                              "OUTPUT(v)\nOUTPUT(w)\nOUTPUT(x)\nOUTPUT(y)\nOUTPUT(z)\n"
+                                                              "v = AND(a, b, c, d, e)\nw = OR(e, d, c, b, a)\n"
+                                                              "x = NAND(a, c, e, b)\ny = NOR(b, d, e)\n"
+                                                              "z = XOR(a, b, c, d, e)\n");
+    BenchParser parser(path);
+    auto manager = std::make_shared<ClassProject::Manager>();
+
+    /* All strategies build into one manager, so equal functions have equal IDs */
+    std::map<label_t, ClassProject::BDD_ID> expected;
+    for (auto strategy : {decomposition_t::Linear, decomposition_t::Balanced, decomposition_t::Greedy}) {
+        CircuitToBDD circuit_to_bdd(manager);
+        circuit_to_bdd.SetDecomposition(strategy);
+        circuit_to_bdd.GenerateBDD(parser.GetCircuit(), parser.GetSortedCircuit(), path);
+        auto outputs = circuit_to_bdd.GetOutputBDDs(parser.GetListOfOutputLabels());
+        if (expected.empty()) {
+            expected = outputs;
+        } else {
+            EXPECT_EQ(outputs, expected) << DecompositionName(strategy);
+        }
+    }
+    std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+
+    decomposition_t parsed;
+    EXPECT_TRUE(ParseDecomposition("greedy", parsed));
+    EXPECT_EQ(parsed, decomposition_t::Greedy);
+    EXPECT_FALSE(ParseDecomposition("random", parsed));
+}
+
+TEST(CircuitToBDDTest, ParallelDumpWritesTheSameFiles) {
+    std::string path = WriteFile("vds_dump_test.bench", "INPUT(a)\nINPUT(b)\nINPUT(c)\n"
+                                                        "OUTPUT(x)\nOUTPUT(y)\nOUTPUT(z)\n"
+                                                        "x = AND(a, b)\ny = XOR(a, b, c)\nz = NOR(x, c)\n");
+    BenchParser parser(path);
+    CircuitToBDD circuit_to_bdd(std::make_shared<ClassProject::Manager>());
+    circuit_to_bdd.GenerateBDD(parser.GetCircuit(), parser.GetSortedCircuit(), path);
+    std::string result_dir = CircuitToBDD::ResultDir(path);
+
+    auto read_dumps = [&]() {
+        std::map<std::string, std::string> files;
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(result_dir)) {
+            if (entry.path().extension() == ".txt" || entry.path().extension() == ".dot") {
+                std::ifstream in(entry.path(), std::ios::binary);
+                files[entry.path().string()].assign(std::istreambuf_iterator<char>(in), {});
+            }
+        }
+        return files;
+    };
+
+    circuit_to_bdd.SetDumpThreads(1);
+    circuit_to_bdd.PrintBDD(parser.GetListOfOutputLabels());
+    auto sequential = read_dumps();
+    std::filesystem::remove_all(result_dir + "/txt");
+    std::filesystem::remove_all(result_dir + "/dot");
+
+    circuit_to_bdd.SetDumpThreads(4);
+    circuit_to_bdd.PrintBDD(parser.GetListOfOutputLabels());
+    EXPECT_EQ(read_dumps(), sequential);
+    EXPECT_EQ(sequential.size(), 6u);
+
+    EXPECT_THROW(circuit_to_bdd.PrintBDD({"missing"}), std::runtime_error);
+    std::filesystem::remove_all(result_dir);
+}
+
+TEST(CircuitToBDDTest, StreamingBuildsTheFunctionsOfGenerateBDD) {
+    /* The gates of the adder in reverse order, so that every gate is read before its fanins,
+       followed by a second definition of s1, which both paths ignore */
+    std::istringstream adder(AdderBench(4));
+    std::string declarations, gates, line;
+    while (std::getline(adder, line)) {
+        if (line.rfind("INPUT", 0) == 0 || line.rfind("OUTPUT", 0) == 0) {
+            declarations += line + "\n";
+        } else {
+            gates.insert(0, line + "\n");
+        }
+    }
+    std::string text = declarations + gates + "s1 = AND(a1, b1)\n";
+    std::string generated_path = WriteFile("vds_stream_generated.bench", text);
+    std::string streamed_path = WriteFile("vds_stream_streamed.bench", text);
+
+    BenchParser parser(generated_path);
+    auto generated_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD generated(generated_manager);
+    generated.GenerateBDD(parser.GetCircuit(), parser.GetSortedCircuit(), generated_path);
+    generated.PrintBDD(parser.GetListOfOutputLabels());
+
+    auto streamed_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD streamed(streamed_manager);
+    std::set<label_t> output_labels = streamed.StreamBDD(streamed_path);
+    EXPECT_EQ(output_labels, parser.GetListOfOutputLabels());
+    streamed.PrintBDD(output_labels);
+
+    /* StreamBDD creates the variables in another order, so the dumps are compared canonically */
+    for (const auto &label : output_labels) {
+        BddDump expected(CircuitToBDD::ResultDir(generated_path) + "/txt/" + label + ".txt");
+        BddDump actual(CircuitToBDD::ResultDir(streamed_path) + "/txt/" + label + ".txt");
+        counterexample_t counterexample;
+        EXPECT_TRUE(IsCanonicallyEquivalent(actual, expected, counterexample)) << label;
+    }
+    ExpectSameFunctions(*generated_manager, generated.GetOutputBDDs(output_labels), *streamed_manager,
+                        streamed.GetOutputBDDs(output_labels), parser.GetCircuit());
+    std::map<std::string, bool> inputs;
+    for (const char *input : {"a0", "a1", "a2", "a3", "b0", "b2", "b3"}) inputs[input] = false;
+    inputs["b1"] = true;
+    EXPECT_TRUE(Evaluate(*streamed_manager, streamed.GetOutputBDDs({"s1"}).at("s1"), inputs));
+
+    for (const auto &path : {generated_path, streamed_path}) {
+        std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(CircuitToBDDTest, EarlyReleaseKeepsTheOutputsAndLowersThePeak) {
+    /* Large enough for several collections */
+    std::string text = MultiplierBench(9);
+    std::string kept_path = WriteFile("vds_release_kept.bench", text);
+    std::string released_path = WriteFile("vds_release_released.bench", text);
+    BenchParser parser(kept_path);
+    const Circuit &circuit = parser.GetCircuit();
+    std::set<label_t> output_labels = parser.GetListOfOutputLabels();
+
+    auto kept_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD kept(kept_manager);
+    kept.GenerateBDD(circuit, parser.GetSortedCircuit(), kept_path);
+    kept.PrintBDD(output_labels);
+
+    auto released_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD released(released_manager);
+    released.SetEarlyRelease(true);
+    released.GenerateBDD(circuit, parser.GetSortedCircuit(), released_path);
+    released.PrintBDD(output_labels);
+
+    /* Both builds create the variables in the same order, so the dumps must match node for node */
+    for (const auto &label : output_labels) {
+        BddDump expected(CircuitToBDD::ResultDir(kept_path) + "/txt/" + label + ".txt");
+        BddDump actual(CircuitToBDD::ResultDir(released_path) + "/txt/" + label + ".txt");
+        EXPECT_TRUE(IsEquivalent(actual, expected)) << label;
+    }
+    EXPECT_LT(released_manager->peakLiveNodeCount(), kept_manager->peakLiveNodeCount());
+    EXPECT_LT(released_manager->liveNodeCount(), kept_manager->liveNodeCount());
+
+    /* Only the gates the outputs read are left, none of them with an ID freed by a collection */
+    std::string gate_map = (std::filesystem::temp_directory_path() / "vds_release.gates").string();
+    released.SaveGateMap(gate_map);
+    std::ifstream in(gate_map);
+    std::string line;
+    std::getline(in, line);
+    std::set<std::string> labels;
+    while (std::getline(in, line)) {
+        labels.insert(line.substr(line.find(',') + 1));
+    }
+    EXPECT_EQ(labels, std::set<std::string>(output_labels.begin(), output_labels.end()));
+
+    std::filesystem::remove(gate_map);
+    for (const auto &path : {kept_path, released_path}) {
+        std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(CircuitToBDDTest, ResumeAfterAnInterruptedBuildGivesTheSameOutputs) {
+    std::string path = WriteFile("vds_resume_test.bench", AdderBench(6));
+    BenchParser parser(path);
+    const Circuit &circuit = parser.GetCircuit();
+    std::string result_dir = CircuitToBDD::ResultDir(path);
+    std::string checkpoint_file = result_dir + "/manager.ckpt", gate_map_file = result_dir + "/gates.ckpt";
+
+    auto reference_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD reference(reference_manager);
+    reference.GenerateBDD(circuit, parser.GetSortedCircuit(), path);
+
+    /* Checkpoint after every gate, as main_bench does, and stop after the tenth */
+    auto interrupted_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD interrupted(interrupted_manager);
+    int checkpoints = 0;
+    interrupted.SetCheckpointHook([&]() {
+        interrupted_manager->checkpoint(checkpoint_file + ".tmp", true);
+        std::filesystem::rename(checkpoint_file + ".tmp", checkpoint_file);
+        interrupted.SaveGateMap(gate_map_file);
+        if (++checkpoints == 10) throw std::runtime_error("interrupted");
+    }, std::chrono::seconds(0));
+    EXPECT_THROW(interrupted.GenerateBDD(circuit, parser.GetSortedCircuit(), path), std::runtime_error);
+
+    auto resumed_manager = std::make_shared<ClassProject::Manager>();
+    resumed_manager->restore(checkpoint_file);
+    CircuitToBDD resumed(resumed_manager);
+    EXPECT_EQ(resumed.RestoreGateMap(gate_map_file, resumed_manager->uniqueTableSize()), 10u);
+    resumed.GenerateBDD(circuit, parser.GetSortedCircuit(), path);
+    ExpectSameFunctions(*reference_manager, reference.GetOutputBDDs(parser.GetListOfOutputLabels()),
+                        *resumed_manager, resumed.GetOutputBDDs(parser.GetListOfOutputLabels()), circuit);
+
+    /* A truncated checkpoint is rejected without touching the manager */
+    std::filesystem::resize_file(checkpoint_file, std::filesystem::file_size(checkpoint_file) / 2);
+    size_t nodes = resumed_manager->uniqueTableSize();
+    EXPECT_THROW(resumed_manager->restore(checkpoint_file), std::runtime_error);
+    EXPECT_EQ(resumed_manager->uniqueTableSize(), nodes);
+    std::filesystem::remove_all(result_dir);
+    std::filesystem::remove(path);
+}
+
+TEST(CircuitToBDDTest, IncrementalBuildRebuildsOnlyTheChangedCones) {
+    std::string adder = AdderBench(4);
+    auto replace = [](std::string text, const std::string &from, const std::string &to) {
+        return text.replace(text.find(from), from.size(), to);
+    };
+
+    /* One gate edited: its fanout cone through the carry chain up to the carry out */
+    ExpectIncrementalRebuild(adder, replace(adder, "g2 = AND(a2, b2)", "g2 = OR(a2, b2)"),
+                             {"g2", "c2", "s3", "p3", "c3"});
+
+    /* A gate added in front of s1, and removed again */
+    std::string buffered = replace(adder, "s1 = XOR(h1, c0)", "t1 = XOR(h1, c0)\ns1 = BUFF(t1)");
+    ExpectIncrementalRebuild(adder, buffered, {"t1", "s1"});
+    ExpectIncrementalRebuild(buffered, adder, {"s1"});
+}
+
+// ======== Result cache ========
+TEST(ResultCacheTest, HitsOnlyIntactEntriesOfTheSameInputs) {
+    std::string path = WriteFile("vds_cache_test.bench", AdderBench(4));
+    std::string cache_dir = (std::filesystem::temp_directory_path() / "vds_cache_test").string();
+    std::filesystem::remove_all(cache_dir);
+    ResultCache cache(cache_dir);
+    BenchParser parser(path);
+    const Circuit &circuit = parser.GetCircuit();
+
+    auto built_manager = std::make_shared<ClassProject::Manager>();
+    CircuitToBDD built(built_manager);
+    built.GenerateBDD(circuit, parser.GetSortedCircuit(), path);
+    auto built_outputs = built.GetOutputBDDs(parser.GetListOfOutputLabels());
+
+    /* Miss on an empty cache, then a hit with the IDs of the build */
+    cache_key_t key = ResultCache::Key(path, "default");
+    ClassProject::Manager manager;
+    std::map<std::string, ClassProject::BDD_ID> outputs;
+    EXPECT_FALSE(cache.Lookup(key, manager, outputs));
+    EXPECT_EQ(manager.uniqueTableSize(), 2u);
+    cache.Store(key, *built_manager, built_outputs);
+    ASSERT_TRUE(cache.Lookup(key, manager, outputs));
+    EXPECT_EQ(outputs, built_outputs);
+    EXPECT_EQ(manager.uniqueTableSize(), built_manager->uniqueTableSize());
+    ExpectSameFunctions(*built_manager, built_outputs, manager, outputs, circuit);
+
+    /* Other options or other contents of the file make another key */
+    cache_key_t other_options = ResultCache::Key(path, "optimize");
+    EXPECT_NE(other_options.name, key.name);
+    EXPECT_FALSE(cache.Lookup(other_options, manager, outputs));
+    WriteFile("vds_cache_test.bench", AdderBench(4) + "# edited\n");
+    cache_key_t edited = ResultCache::Key(path, "default");
+    EXPECT_NE(edited.digest, key.digest);
+    EXPECT_EQ(edited.input_size, key.input_size + 9);
+    EXPECT_FALSE(cache.Lookup(edited, manager, outputs));
+
+    /* An entry found under the name of a key, but stored for other inputs, is a miss */
+    cache_key_t colliding = key;
+    colliding.digest = edited.digest;
+    EXPECT_FALSE(cache.Lookup(colliding, manager, outputs));
+
+    /* A corrupt or truncated checkpoint is a miss that leaves the manager alone */
+    std::string checkpoint = cache_dir + "/" + key.name + ".ckpt";
+    ClassProject::Manager untouched;
+    {
+        std::fstream file(checkpoint, std::ios::binary | std::ios::in | std::ios::out);
+        auto middle = static_cast<std::streamoff>(std::filesystem::file_size(checkpoint) / 2);
+        file.seekg(middle);
+        char byte = static_cast<char>(file.get() ^ 0xff);
+        file.seekp(middle);
+        file.put(byte);
+    }
+    EXPECT_FALSE(cache.Lookup(key, untouched, outputs));
+    std::filesystem::resize_file(checkpoint, std::filesystem::file_size(checkpoint) / 2);
+    EXPECT_FALSE(cache.Lookup(key, untouched, outputs));
+    EXPECT_EQ(untouched.uniqueTableSize(), 2u);
+
+    /* Storing again repairs the entry */
+    cache.Store(key, *built_manager, built_outputs);
+    EXPECT_TRUE(cache.Lookup(key, untouched, outputs));
+    std::filesystem::remove_all(cache_dir);
+    std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+    std::filesystem::remove(path);
+}
+
+// ======== Verification ========
+TEST(VerifyTest, ComparesSharedNodesAndSeveralRoots) {
+    /* x = a AND b and y = a XOR b, numbered differently in two managers */
+    std::string first = WriteFile("vds_verify_first.txt",
+                                  "Variable Node: 7 Top Var Id: 2 Top Var Name: a Low: 5 High: 6\n"
+                                  "Variable Node: 6 Top Var Id: 3 Top Var Name: b Low: 1 High: 0\n"
+                                  "Variable Node: 5 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                                  "Variable Node: 4 Top Var Id: 2 Top Var Name: a Low: 0 High: 5\n"
+                                  "Terminal Node: 1\nTerminal Node: 0\n");
+    std::string second = WriteFile("vds_verify_second.txt",
+                                   "Variable Node: 12 Top Var Id: 10 Top Var Name: a Low: 11 High: 9\n"
+                                   "Variable Node: 11 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                                   "Variable Node: 9 Top Var Id: 3 Top Var Name: b Low: 1 High: 0\n"
+                                   "Variable Node: 8 Top Var Id: 10 Top Var Name: a Low: 0 High: 11\n"
+                                   "Terminal Node: 0\nTerminal Node: 1\n");
+    std::string swapped = WriteFile("vds_verify_swapped.txt",
+                                    "Variable Node: 7 Top Var Id: 2 Top Var Name: a Low: 6 High: 5\n"
+                                    "Variable Node: 6 Top Var Id: 3 Top Var Name: b Low: 1 High: 0\n"
+                                    "Variable Node: 5 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                                    "Variable Node: 4 Top Var Id: 2 Top Var Name: a Low: 0 High: 5\n"
+                                    "Terminal Node: 1\nTerminal Node: 0\n");
+
+    BddDump dump(first);
+    EXPECT_EQ(dump.Size(), 6u);
+    EXPECT_EQ(dump.Roots(), (std::vector<uint64_t>{7, 4}));
+    EXPECT_TRUE(IsEquivalent(dump, BddDump(second)));
+    EXPECT_FALSE(IsEquivalent(dump, BddDump(swapped)));
+
+    std::string malformed = WriteFile("vds_verify_malformed.txt", "Variable Node: x\n");
+    EXPECT_THROW(BddDump{malformed}, std::runtime_error);
+    for (const auto &path : {first, second, swapped, malformed}) {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(VerifyTest, DumpPoolReportsEveryFileAndFailsOnNone) {
+    std::filesystem::path actual = std::filesystem::temp_directory_path() / "vds_verify_actual";
+    std::filesystem::path expected = std::filesystem::temp_directory_path() / "vds_verify_expected";
+    std::filesystem::remove_all(actual);
+    std::filesystem::remove_all(expected);
+    std::filesystem::create_directories(actual);
+    std::filesystem::create_directories(expected);
+    auto write = [](const std::filesystem::path &path, const std::string &text) {
+        std::ofstream(path, std::ios::binary) << text;
+    };
+    std::string and_ab = "Variable Node: 5 Top Var Id: 2 Top Var Name: a Low: 0 High: 4\n"
+                         "Variable Node: 4 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                         "Terminal Node: 1\nTerminal Node: 0\n";
+    std::string or_ab = "Variable Node: 5 Top Var Id: 2 Top Var Name: a Low: 4 High: 1\n"
+                        "Variable Node: 4 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                        "Terminal Node: 1\nTerminal Node: 0\n";
+
+    /* No dumps at all is a failure, not a pass */
+    EXPECT_TRUE(VerifyDumps(actual.string(), expected.string(), 4).empty());
+    EXPECT_EQ(VerifyExitStatus({}), 1);
+    EXPECT_THROW(VerifyDumps((actual / "missing").string(), expected.string(), 4), std::runtime_error);
+
+    for (const char *name : {"w.txt", "x.txt", "y.txt", "z.txt"}) {
+        write(actual / name, and_ab);
+        write(expected / name, and_ab);
+    }
+    auto results = VerifyDumps(actual.string(), expected.string(), 4);
+    ASSERT_EQ(results.size(), 4u);
+    EXPECT_EQ(results[0].filename, "w.txt");
+    EXPECT_EQ(VerifyExitStatus(results), 0);
+
+    /* One file not equivalent */
+    write(expected / "x.txt", or_ab);
+    results = VerifyDumps(actual.string(), expected.string(), 4);
+    EXPECT_EQ(results[1].verdict, dump_verdict_t::NotEquivalent);
+    EXPECT_EQ(results[2].verdict, dump_verdict_t::Equivalent);
+    EXPECT_EQ(VerifyExitStatus(results), 1);
+
+    /* One expected file missing */
+    write(expected / "x.txt", and_ab);
+    std::filesystem::remove(expected / "z.txt");
+    results = VerifyDumps(actual.string(), expected.string(), 4);
+    EXPECT_EQ(results[1].verdict, dump_verdict_t::Equivalent);
+    EXPECT_EQ(results[3].verdict, dump_verdict_t::Missing);
+    EXPECT_EQ(VerifyExitStatus(results), 1);
+
+    std::filesystem::remove_all(actual);
+    std::filesystem::remove_all(expected);
+}
+
+TEST(VerifyTest, CanonicalCheckIgnoresTheVariableOrder) {
+    /* a AND b with a on top, the same with b on top, and a OR b */
+    std::string and_ab = WriteFile("vds_canonical_and_ab.txt",
+                                   "Variable Node: 4 Top Var Id: 2 Top Var Name: a Low: 0 High: 3\n"
+                                   "Variable Node: 3 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                                   "Terminal Node: 1\nTerminal Node: 0\n");
+    std::string and_ba = WriteFile("vds_canonical_and_ba.txt",
+                                   "Variable Node: 4 Top Var Id: 2 Top Var Name: b Low: 0 High: 3\n"
+                                   "Variable Node: 3 Top Var Id: 3 Top Var Name: a Low: 0 High: 1\n"
+                                   "Terminal Node: 1\nTerminal Node: 0\n");
+    std::string or_ab = WriteFile("vds_canonical_or_ab.txt",
+                                  "Variable Node: 4 Top Var Id: 2 Top Var Name: a Low: 3 High: 1\n"
+                                  "Variable Node: 3 Top Var Id: 3 Top Var Name: b Low: 0 High: 1\n"
+                                  "Terminal Node: 1\nTerminal Node: 0\n");
+
+    counterexample_t counterexample;
+    EXPECT_FALSE(IsEquivalent(BddDump(and_ab), BddDump(and_ba)));
+    EXPECT_TRUE(IsCanonicallyEquivalent(BddDump(and_ab), BddDump(and_ba), counterexample));
+
+    EXPECT_FALSE(IsCanonicallyEquivalent(BddDump(and_ab), BddDump(or_ab), counterexample));
+    EXPECT_EQ(counterexample.root, 0u);
+    EXPECT_EQ(counterexample.assignment, (std::vector<std::pair<std::string, bool>>{{"a", false}, {"b", true}}));
+    EXPECT_FALSE(counterexample.first_value);
+    for (const auto &path : {and_ab, and_ba, or_ab}) {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(VerifyTest, CircuitEquivalenceStopsAtTheFirstDifferingOutput) {
+    std::string original = WriteFile("vds_equiv_original.bench", "INPUT(a)\nINPUT(b)\nINPUT(c)\n"
+                                                                  "OUTPUT(x)\nOUTPUT(y)\nOUTPUT(z)\n"
+                                                                  "x = NAND(a, b)\ny = XOR(x, c)\nz = OR(a, c)\n");
+    std::string resynthesized = WriteFile("vds_equiv_resynthesized.bench", "INPUT(c)\nINPUT(b)\nINPUT(a)\n"
+                                                                            "OUTPUT(x)\nOUTPUT(y)\nOUTPUT(z)\n"
+                                                                            "na = NOT(a)\nnb = NOT(b)\nnc = NOT(c)\n"
+                                                                            "x = OR(na, nb)\ny = XOR(c, x)\n"
+                                                                            "z = NAND(na, nc)\n");
+    std::string broken = WriteFile("vds_equiv_broken.bench", "INPUT(a)\nINPUT(b)\nINPUT(c)\n"
+                                                              "OUTPUT(x)\nOUTPUT(y)\nOUTPUT(z)\n"
+                                                              "x = NAND(a, b)\ny = XOR(x, c)\nz = AND(a, c)\n");
+    BenchParser first(original), second(resynthesized), third(broken);
+
+    circuit_mismatch_t mismatch;
+    size_t compared = 0;
+    auto manager = std::make_shared<ClassProject::Manager>();
+    EXPECT_TRUE(CheckCircuitEquivalence(manager, first.GetCircuit(), second.GetCircuit(), mismatch, compared));
+    EXPECT_EQ(compared, 3u);
+
+    /* z = a OR c and z = a AND c differ for a=0, c=1 */
+    EXPECT_FALSE(CheckCircuitEquivalence(manager, first.GetCircuit(), third.GetCircuit(), mismatch, compared));
+    EXPECT_EQ(mismatch.output, "z");
+    std::map<std::string, bool> inputs = {{"a", false}, {"b", false}, {"c", false}};
+    for (const auto &value : mismatch.counterexample.assignment) {
+        inputs[value.first] = value.second;
+    }
+    EXPECT_EQ(Simulate(first.GetCircuit(), inputs).at("z"), mismatch.counterexample.first_value);
+    EXPECT_NE(Simulate(third.GetCircuit(), inputs).at("z"), mismatch.counterexample.first_value);
+
+    std::string renamed = WriteFile("vds_equiv_renamed.bench", "INPUT(a)\nOUTPUT(w)\nw = NOT(a)\n");
+    EXPECT_FALSE(CheckCircuitEquivalence(manager, first.GetCircuit(), BenchParser(renamed).GetCircuit(), mismatch,
+                                         compared));
+    EXPECT_EQ(mismatch.unmatched.size(), 4u);
+    for (const auto &path : {original, resynthesized, broken, renamed}) {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(SuiteResultsTest, BaselineComparisonFlagsOnlyRealRegressions) {
+    run_record_t run;
+    run.status = run_status_t::Ok;
+    run.build = {1.0, 1.0};
+    run.peak_rss_kb = 10000;
+    run.nodes = 500;
+    run.cache = {100, 40, 50, 10};
+    suite_results_t baseline{5, decomposition_t::Balanced, {{"c17", "c17.bench", {run, run, run, run, run}}}};
+    baseline.circuits[0].runs[1].build.wall = 1.2;
+    baseline.circuits[0].runs[2].build.wall = 0.9;
+    baseline.circuits[0].runs[3].build.wall = 1.1;
+
+    std::string json = (std::filesystem::temp_directory_path() / "vds_suite_baseline.json").string();
+    WriteSuiteJson(json, baseline);
+    suite_results_t read = ReadSuiteJson(json);
+    std::filesystem::remove(json);
+    ASSERT_EQ(read.circuits.size(), 1u);
+    EXPECT_EQ(read.decomposition, decomposition_t::Balanced);
+    EXPECT_EQ(read.circuits[0].runs[1].build.wall, 1.2);
+    EXPECT_EQ(read.circuits[0].runs[2].cache.computedHits, 40u);
+
+    auto regressed = [&](const suite_results_t &current) {
+        std::vector<std::string> metrics;
+        for (const auto &comparison : CompareToBaseline(read, current, regression_tolerance_t())) {
+            if (comparison.regression) metrics.push_back(comparison.metric);
+        }
+        return metrics;
+    };
+    EXPECT_TRUE(regressed(read).empty());
+
+    /* A median 15% slower is within the noise of the baseline, 50% is not */
+    suite_results_t current = read;
+    for (auto &slower : current.circuits[0].runs) slower.build.wall *= 1.15;
+    EXPECT_TRUE(regressed(current).empty());
+    for (auto &slower : current.circuits[0].runs) slower.build.wall = 1.5;
+    EXPECT_EQ(regressed(current), std::vector<std::string>{"build [s]"});
+
+    /* Node counts must match in both directions */
+    current = read;
+    current.circuits[0].runs.back().nodes = 499;
+    current.circuits[0].runs.back().cache.computedHits = 20;
+    EXPECT_EQ(regressed(current), (std::vector<std::string>{"nodes", "hit rate"}));
+
+    current.circuits[0].runs.back().status = run_status_t::Timeout;
+    EXPECT_EQ(regressed(current), std::vector<std::string>{"status"});
+}
+
+TEST(SuiteResultsTest, IdenticalCodePassesTheGate) {
+    /* Measures the stages of VDSProject_suite in this process, each run with fresh dumps */
+    std::string path = WriteFile("vds_suite_adder.bench", AdderBench(8));
+    auto measure = [&](unsigned repetitions) {
+        suite_results_t results{repetitions, decomposition_t::Linear, {{"adder", path, {}}}};
+        for (unsigned i = 0; i < repetitions; ++i) {
+            std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+            run_record_t run;
+            StageTimer parse_timer;
+            BenchParser parser(path);
+            run.parse = parse_timer.Elapsed();
+            auto manager = std::make_shared<ClassProject::Manager>();
+            CircuitToBDD circuit_to_bdd(manager);
+            StageTimer build_timer;
+            circuit_to_bdd.GenerateBDD(parser.GetCircuit(), parser.GetSortedCircuit(), path);
+            run.build = build_timer.Elapsed();
+            run.nodes = manager->liveNodeCount();
+            run.peak_live_nodes = manager->peakLiveNodeCount();
+            run.cache = manager->cacheStatistics();
+            StageTimer dump_timer;
+            circuit_to_bdd.PrintBDD(parser.GetListOfOutputLabels());
+            run.dump = dump_timer.Elapsed();
+            run.status = run_status_t::Ok;
+            results.circuits[0].runs.push_back(run);
+        }
+        return results;
+    };
+    auto regressions = [](const suite_results_t &baseline, const suite_results_t &current) {
+        std::vector<std::string> metrics;
+        for (const auto &comparison : CompareToBaseline(baseline, current, regression_tolerance_t())) {
+            if (comparison.regression) metrics.push_back(comparison.metric + ": " + comparison.note);
+        }
+        return metrics;
+    };
+
+    suite_results_t baseline = measure(5);
+    EXPECT_EQ(regressions(baseline, measure(5)), std::vector<std::string>());
+    std::filesystem::remove_all(CircuitToBDD::ResultDir(path));
+    std::filesystem::remove(path);
+
+    /* Three repetitions scattered as much as a dump of c432 on a busy machine; too few to judge the times */
+    run_record_t run;
+    run.status = run_status_t::Ok;
+    suite_results_t few{3, decomposition_t::Linear, {{"c432", "c432.bench", {run, run, run}}}};
+    suite_results_t scattered = few;
+    for (size_t i = 0; i < 3; ++i) {
+        few.circuits[0].runs[i].dump.wall = 0.039 + 0.001 * static_cast<double>(i);
+        scattered.circuits[0].runs[i].dump.wall = 0.058 + 0.004 * static_cast<double>(i);
+    }
+    EXPECT_EQ(regressions(few, scattered), std::vector<std::string>());
+    regression_tolerance_t three;
+    three.min_repetitions = 3;
+    EXPECT_TRUE(CompareToBaseline(few, scattered, three).back().regression);
+}
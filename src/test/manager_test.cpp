@@ -7,6 +7,8 @@
  */
 
 #include "Tests.h"
+#include "../BDDStore.h"
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <filesystem>
@@ -59,6 +61,41 @@ TEST_F(ManagerTest, CoFactorFunctionsCorrectly) {
     EXPECT_EQ(manager->coFactorFalse(x, x), manager->False());
 }
 
+TEST_F(ManagerTest, CoFactorByVariablesAboveAtAndBelowTheTopVariable) {
+    /* Variables of their own, so that the IDs are in the order they are created */
+    BDD_ID p = manager->createVar("p");
+    BDD_ID q = manager->createVar("q");
+    BDD_ID pAndQ = manager->and2(p, q);
+    BDD_ID r = manager->createVar("r");
+    BDD_ID s = manager->createVar("s");
+    BDD_ID t = manager->createVar("t");
+    BDD_ID f = manager->or2(manager->and2(r, s), t);
+    BDD_ID sAndT = manager->and2(s, t);
+    ASSERT_EQ(manager->topVar(f), r);
+    ASSERT_LT(pAndQ, r);
+    ASSERT_GT(sAndT, r);
+    size_t nodes = manager->uniqueTableSize();
+
+    /* A variable above the top one: f does not depend on it */
+    EXPECT_EQ(manager->coFactorTrue(f, p), f);
+    EXPECT_EQ(manager->coFactorFalse(f, p), f);
+    EXPECT_EQ(manager->uniqueTableSize(), nodes);
+
+    /* The top variable itself: the children of f */
+    EXPECT_EQ(manager->coFactorTrue(f, r), manager->or2(s, t));
+    EXPECT_EQ(manager->coFactorFalse(f, r), t);
+
+    /* A variable below the top one */
+    EXPECT_EQ(manager->coFactorTrue(f, s), manager->or2(r, t));
+    EXPECT_EQ(manager->coFactorFalse(f, s), t);
+
+    /* Nodes that are not variables leave f as is, whether their IDs are smaller or larger than its top variable */
+    for (BDD_ID x : {pAndQ, sAndT, f}) {
+        EXPECT_EQ(manager->coFactorTrue(f, x), f);
+        EXPECT_EQ(manager->coFactorFalse(f, x), f);
+    }
+}
+
 TEST_F(ManagerTest, LogicGatesWork) {
     BDD_ID a = manager->createVar("a");
     BDD_ID b = manager->createVar("b");
@@ -126,6 +163,68 @@ TEST_F(ManagerTest, UniqueTableSizeTracksNodeCount) {
     EXPECT_GT(newSize, initialSize);
 }
 
+TEST_F(ManagerTest, CollectGarbageFreesUnreachableNodes) {
+    manager->xor2(c_or_d_id, a_and_b_id);
+    size_t live = manager->liveNodeCount();
+    size_t peak = manager->peakLiveNodeCount();
+    EXPECT_EQ(peak, live);
+
+    /* Keep f1 only; the other functions of the fixture and g become garbage */
+    size_t freed = manager->collectGarbage({f1_id});
+    EXPECT_GT(freed, 0);
+    EXPECT_EQ(manager->liveNodeCount(), live - freed);
+    EXPECT_EQ(manager->peakLiveNodeCount(), peak);
+    EXPECT_TRUE(manager->isVariable(a_id));
+    EXPECT_EQ(manager->collectGarbage({f1_id}), 0);
+
+    /* Freed IDs are reused and results are still canonical */
+    size_t table_size = manager->uniqueTableSize();
+    BDD_ID g2 = manager->xor2(manager->or2(c_id, d_id), manager->and2(a_id, b_id));
+    EXPECT_EQ(manager->uniqueTableSize(), table_size);
+    EXPECT_EQ(manager->coFactorTrue(manager->coFactorTrue(g2, a_id), b_id), manager->nor2(c_id, d_id));
+    EXPECT_EQ(manager->or2(manager->and2(a_id, b_id), manager->or2(c_id, d_id)), f1_id);
+    EXPECT_NE(g2, f1_id);
+}
+
+TEST_F(ManagerTest, CheckpointKeepsFreedSlotsFree) {
+    manager->collectGarbage({f1_id});
+    size_t live = manager->liveNodeCount();
+    std::string filename = "collected.ckpt";
+    manager->checkpoint(filename);
+
+    ClassProject::Manager target;
+    target.restore(filename);
+    std::remove(filename.c_str());
+    EXPECT_EQ(target.liveNodeCount(), live);
+    EXPECT_EQ(target.or2(target.and2(a_id, b_id), target.or2(c_id, d_id)), f1_id);
+    target.xor2(a_id, b_id);
+    EXPECT_EQ(target.uniqueTableSize(), manager->uniqueTableSize());
+}
+
+TEST_F(ManagerTest, AnalyzeRootsMatchesFindNodesAndFindVars) {
+    /* More roots than one batch of 512, with repeated and constant roots */
+    std::vector<BDD_ID> functions = {f1_id, a_and_b_id, c_or_d_id, a_xor_b_id, neg_b_id, true_id};
+    std::vector<BDD_ID> roots;
+    for (size_t i = 0; i < 600; ++i) roots.push_back(functions[i % functions.size()]);
+
+    RootAnalysis analysis = manager->analyzeRoots(roots);
+    EXPECT_EQ(analysis.variables, (std::vector<BDD_ID>{a_id, b_id, c_id, d_id}));
+
+    std::set<BDD_ID> all_nodes;
+    for (size_t r = 0; r < roots.size(); ++r) {
+        std::set<BDD_ID> nodes, vars;
+        manager->findNodes(roots[r], nodes);
+        manager->findVars(roots[r], vars);
+        all_nodes.insert(nodes.begin(), nodes.end());
+        EXPECT_EQ(analysis.nodeCounts[r], nodes.size());
+        for (size_t v = 0; v < analysis.variables.size(); ++v) {
+            EXPECT_EQ(analysis.inSupport(r, v), vars.count(analysis.variables[v]) == 1);
+        }
+    }
+    EXPECT_EQ(analysis.sharedNodeCount, all_nodes.size());
+    EXPECT_EQ(manager->analyzeRoots({f1_id}).sharedNodeCount, analysis.nodeCounts[0]);
+}
+
 TEST_F(ManagerTest, VisualizeBDDFunctionExample) { // (a+b)(c+d)
     BDD_ID a = manager->createVar("a");
     BDD_ID b = manager->createVar("b");
@@ -246,3 +345,155 @@ TEST_F(ManagerTest, CoFactorTrueAndFalsePreserveSemantics) {
     EXPECT_EQ(coF, b);
 }
 
+
+// ======== Persistence ========
+TEST(PersistenceTest, SaveLoadRoundTrip) {
+    ClassProject::Manager source;
+    BDD_ID a = source.createVar("a");
+    BDD_ID b = source.createVar("b");
+    BDD_ID c = source.createVar("c");
+    BDD_ID d = source.createVar("d");
+    BDD_ID f = source.and2(source.or2(a, b), source.or2(c, d));
+    BDD_ID g = source.xor2(a, c);
+
+    std::string filename = "round_trip.bdd";
+    source.save(filename, {{"f", f}, {"g", g}, {"one", source.True()}});
+
+    ClassProject::Manager target;
+    auto roots = target.load(filename);
+    std::remove(filename.c_str());
+
+    ASSERT_EQ(roots.size(), 3);
+    BDD_ID ta = target.createVar("a");
+    BDD_ID tb = target.createVar("b");
+    BDD_ID tc = target.createVar("c");
+    BDD_ID td = target.createVar("d");
+    EXPECT_EQ(roots["f"], target.and2(target.or2(ta, tb), target.or2(tc, td)));
+    EXPECT_EQ(roots["g"], target.xor2(ta, tc));
+    EXPECT_EQ(roots["one"], target.True());
+}
+
+TEST(PersistenceTest, LoadAdaptsToExistingVariableOrder) {
+    ClassProject::Manager source;
+    BDD_ID a = source.createVar("a");
+    BDD_ID b = source.createVar("b");
+    BDD_ID c = source.createVar("c");
+    BDD_ID f = source.or2(source.and2(a, b), c);
+
+    std::string filename = "reordered.bdd";
+    source.save(filename, {{"f", f}});
+
+    ClassProject::Manager target;
+    BDD_ID tc = target.createVar("c");
+    BDD_ID tb = target.createVar("b");
+    BDD_ID ta = target.createVar("a");
+    auto roots = target.load(filename);
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(roots["f"], target.or2(target.and2(ta, tb), tc));
+}
+
+TEST(PersistenceTest, LoadRejectsForeignFile) {
+    std::string filename = "not_a_bdd.bdd";
+    std::ofstream(filename) << "digraph BDD {}\n";
+    ClassProject::Manager manager;
+    EXPECT_THROW(manager.load(filename), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
+TEST(PersistenceTest, MappedStoreAnswersQueriesInPlace) {
+    ClassProject::Manager manager;
+    BDD_ID a = manager.createVar("a");
+    BDD_ID b = manager.createVar("b");
+    BDD_ID c = manager.createVar("c");
+    BDD_ID f = manager.or2(manager.and2(a, b), c);
+    BDD_ID g = manager.xor2(a, b);
+
+    std::string filename = "mapped.store";
+    ClassProject::BDDStore::write(manager, {{"f", f}, {"g", g}}, filename);
+    ClassProject::BDDStore store(filename);
+    std::remove(filename.c_str()); // the mapping stays valid
+
+    ASSERT_EQ(store.varCount(), 3);
+    EXPECT_EQ(store.varName(0), "a");
+    EXPECT_EQ(store.varName(2), "c");
+    EXPECT_THROW(store.root("h"), std::runtime_error);
+
+    auto fRef = store.root("f");
+    auto gRef = store.root("g");
+    for (int bits = 0; bits < 8; ++bits) {
+        std::vector<bool> assignment{bool(bits & 1), bool(bits & 2), bool(bits & 4)};
+        EXPECT_EQ(store.evaluate(fRef, assignment), (assignment[0] && assignment[1]) || assignment[2]);
+        EXPECT_EQ(store.evaluate(gRef, assignment), assignment[0] != assignment[1]);
+    }
+    EXPECT_EQ(store.satCount(fRef), 5.0);
+    EXPECT_EQ(store.satCount(gRef), 4.0);
+    EXPECT_EQ(store.topVar(fRef), 0);
+    EXPECT_EQ(store.topVar(store.coFactorFalse(fRef)), 2);
+    EXPECT_EQ(store.coFactorFalse(store.coFactorFalse(fRef)), 0);
+    EXPECT_TRUE(store.isConstant(store.coFactorTrue(store.coFactorFalse(fRef))));
+}
+
+TEST(PersistenceTest, MappedStoreRejectsCorruptFiles) {
+    ClassProject::Manager manager;
+    BDD_ID a = manager.createVar("a");
+    BDD_ID b = manager.createVar("b");
+    std::string filename = "corrupt.store";
+    ClassProject::BDDStore::write(manager, {{"f", manager.and2(a, b)}}, filename);
+    std::ifstream in(filename, std::ios::binary);
+    const std::string valid((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    /* Header fields: nodeCount at 16, varsOffset at 32, nodesOffset at 40 */
+    auto field = [&](size_t offset) {
+        uint64_t value;
+        std::memcpy(&value, valid.data() + offset, sizeof(value));
+        return value;
+    };
+    auto rejects = [&](size_t offset, const void *value, size_t size) {
+        std::string bytes = valid;
+        std::memcpy(&bytes[offset], value, size);
+        std::ofstream(filename, std::ios::binary) << bytes;
+        bool thrown = false;
+        try {
+            ClassProject::BDDStore store(filename);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        return thrown;
+    };
+
+    uint64_t huge = UINT64_MAX / 4;
+    EXPECT_TRUE(rejects(16, &huge, sizeof(huge)));                 // nodeCount * entry size overflows
+    EXPECT_TRUE(rejects(field(32), &huge, sizeof(huge)));          // name of variable 0 outside the file
+    uint32_t child = 7;
+    EXPECT_TRUE(rejects(field(40) + 2 * 12 + 4, &child, sizeof(child))); // low child of node 2 after it
+    EXPECT_TRUE(rejects(field(40) + 3 * 12 + 8, &child, sizeof(child))); // high child of node 3 out of range
+    std::ofstream(filename, std::ios::binary) << valid;
+    EXPECT_NO_THROW(ClassProject::BDDStore store(filename));
+    std::remove(filename.c_str());
+}
+
+TEST(PersistenceTest, CheckpointRestoresCompleteState) {
+    ClassProject::Manager source;
+    BDD_ID a = source.createVar("a");
+    BDD_ID b = source.createVar("b");
+    BDD_ID c = source.createVar("c");
+    BDD_ID f = source.and2(source.or2(a, b), c);
+
+    std::string filename = "state.ckpt";
+    source.checkpoint(filename, true);
+
+    ClassProject::Manager target;
+    target.createVar("unrelated");
+    target.restore(filename);
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(target.uniqueTableSize(), source.uniqueTableSize());
+    EXPECT_EQ(target.createVar("b"), b);
+    EXPECT_TRUE(target.isVariable(c));
+    EXPECT_EQ(target.getTopVarName(f), "a");
+    EXPECT_EQ(target.and2(target.or2(a, b), c), f);
+    EXPECT_EQ(target.uniqueTableSize(), source.uniqueTableSize());
+    EXPECT_NE(target.createVar("unrelated"), b);
+}
@@ -0,0 +1,353 @@
+/*=============================================================================
+    Reading and comparing the txt dumps written by CircuitToBDD::PrintBDD
+=============================================================================*/
+
+#include "VerifyLib.h"
+#include "../Manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+	/* Splits a line at single spaces */
+	std::vector<std::string_view> Split(std::string_view line) {
+		std::vector<std::string_view> fields;
+		size_t start = 0;
+		while (start <= line.size()) {
+			size_t end = line.find(' ', start);
+			if (end == std::string_view::npos) end = line.size();
+			if (end > start) fields.push_back(line.substr(start, end - start));
+			start = end + 1;
+		}
+		return fields;
+	}
+
+	uint64_t ParseId(std::string_view field, const std::string &file) {
+		uint64_t value = 0;
+		auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+		if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+			throw std::runtime_error(file + ": '" + std::string(field) + "' is not a node ID");
+		}
+		return value;
+	}
+
+	/* An assignment under which f and g differ, with the value of f under it */
+	counterexample_t Distinguish(ClassProject::ManagerInterface &manager, ClassProject::BDD_ID f, ClassProject::BDD_ID g,
+	                             size_t root) {
+		counterexample_t counterexample;
+		counterexample.root = root;
+		counterexample.assignment = SatisfyingPath(manager, manager.xor2(f, g));
+
+		/* The XOR is 1 for every value of the variables off the path, but
+		   f alone may still depend on them; those are set to 0 */
+		std::unordered_map<std::string, bool> values(counterexample.assignment.begin(),
+		                                             counterexample.assignment.end());
+		while (!manager.isConstant(f)) {
+			auto value = values.find(manager.getTopVarName(f));
+			f = value != values.end() && value->second ? manager.coFactorTrue(f) : manager.coFactorFalse(f);
+		}
+		counterexample.first_value = f == manager.True();
+		return counterexample;
+	}
+
+	struct pair_hash {
+		size_t operator()(const std::pair<uint64_t, uint64_t> &pair) const {
+			uint64_t hash = pair.first * 0x9e3779b97f4a7c15ULL ^ pair.second;
+			return static_cast<size_t>(hash ^ (hash >> 29));
+		}
+	};
+}
+
+BddDump::BddDump(const std::string &txt_file) {
+	std::ifstream in(txt_file, std::ios::binary);
+	if (!in.is_open()) {
+		throw std::runtime_error("invalid file: " + txt_file);
+	}
+	std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	std::unordered_map<std::string_view, uint32_t> var_of_name;
+	std::vector<uint64_t> ids;
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find('\n', start);
+		if (end == std::string::npos) end = text.size();
+		std::string_view line(text.data() + start, end - start);
+		start = end + 1;
+
+		/* "Terminal Node: N" or
+		   "Variable Node: N Top Var Id: V Top Var Name: name Low: l High: h" */
+		std::vector<std::string_view> fields = Split(line);
+		uint64_t id;
+		node_t node{0, 0, 0};
+		if (fields.size() == 3 && fields[0] == "Terminal") {
+			id = ParseId(fields[2], txt_file);
+			node.low = node.high = id;
+		} else if (fields.size() == 15 && fields[0] == "Variable") {
+			id = ParseId(fields[2], txt_file);
+			auto var = var_of_name.find(fields[10]);
+			if (var == var_of_name.end()) {
+				var_names.emplace_back(fields[10]);
+				var_ids.push_back(ParseId(fields[6], txt_file));
+				var = var_of_name.emplace(fields[10], static_cast<uint32_t>(var_names.size() - 1)).first;
+			}
+			node.var = var->second;
+			node.low = ParseId(fields[12], txt_file);
+			node.high = ParseId(fields[14], txt_file);
+		} else if (fields.empty()) {
+			continue;
+		} else {
+			throw std::runtime_error(txt_file + ": malformed line '" + std::string(line) + "'");
+		}
+		if (index_of_id.emplace(id, static_cast<uint32_t>(nodes.size())).second) {
+			nodes.push_back(node);
+			ids.push_back(id);
+		}
+	}
+
+	/* Roots are the nodes no other node refers to */
+	std::vector<bool> referenced(nodes.size(), false);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (IsTerminal(ids[i])) continue;
+		for (uint64_t child : {nodes[i].low, nodes[i].high}) {
+			auto found = index_of_id.find(child);
+			if (found != index_of_id.end()) referenced[found->second] = true;
+		}
+	}
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (!referenced[i]) roots.push_back(ids[i]);
+	}
+}
+
+const BddDump::node_t *BddDump::Find(uint64_t id) const {
+	auto found = index_of_id.find(id);
+	return found == index_of_id.end() ? nullptr : &nodes[found->second];
+}
+
+bool IsEquivalent(const BddDump &first, const BddDump &second) {
+	if (first.Roots().size() != second.Roots().size()) {
+		return false;
+	}
+
+	/* Variable names are compared through the indices of the second dump */
+	const uint32_t NO_VAR = UINT32_MAX;
+	std::unordered_map<std::string_view, uint32_t> second_var;
+	for (uint32_t var = 0; var < second.VarNames().size(); ++var) {
+		second_var.emplace(second.VarNames()[var], var);
+	}
+	std::vector<uint32_t> translated(first.VarNames().size(), NO_VAR);
+	for (uint32_t var = 0; var < first.VarNames().size(); ++var) {
+		auto found = second_var.find(first.VarNames()[var]);
+		if (found != second_var.end()) translated[var] = found->second;
+	}
+
+	/* A pair is only compared the first time it is reached; in a DAG every
+	   pair seen before either matched or is still on the stack */
+	std::unordered_set<std::pair<uint64_t, uint64_t>, pair_hash> visited;
+	std::vector<std::pair<uint64_t, uint64_t>> stack;
+	for (size_t root = 0; root < first.Roots().size(); ++root) {
+		stack.emplace_back(first.Roots()[root], second.Roots()[root]);
+		while (!stack.empty()) {
+			auto pair = stack.back();
+			stack.pop_back();
+			if (!visited.insert(pair).second) continue;
+
+			const BddDump::node_t *node1 = first.Find(pair.first);
+			const BddDump::node_t *node2 = second.Find(pair.second);
+			if (node1 == nullptr || node2 == nullptr) return false;
+			bool terminal1 = BddDump::IsTerminal(pair.first), terminal2 = BddDump::IsTerminal(pair.second);
+			if (terminal1 || terminal2) {
+				if (pair.first != pair.second) return false;
+				continue;
+			}
+			if (translated[node1->var] != node2->var) return false;
+			stack.emplace_back(node1->high, node2->high);
+			stack.emplace_back(node1->low, node2->low);
+		}
+	}
+	return true;
+}
+
+std::vector<ClassProject::BDD_ID> ImportDump(ClassProject::ManagerInterface &manager, const BddDump &dump) {
+	std::vector<uint32_t> by_id(dump.VarNames().size());
+	for (uint32_t var = 0; var < by_id.size(); ++var) by_id[var] = var;
+	std::sort(by_id.begin(), by_id.end(),
+	          [&](uint32_t a, uint32_t b) { return dump.VarIds()[a] < dump.VarIds()[b]; });
+	std::vector<ClassProject::BDD_ID> variables(by_id.size());
+	for (uint32_t var : by_id) {
+		variables[var] = manager.createVar(dump.VarNames()[var]);
+	}
+
+	/* Post-order, so that both children are imported before their parent */
+	std::unordered_map<uint64_t, ClassProject::BDD_ID> imported{{0, manager.False()}, {1, manager.True()}};
+	std::vector<std::pair<uint64_t, bool>> stack;
+	std::vector<ClassProject::BDD_ID> roots;
+	for (uint64_t root : dump.Roots()) {
+		stack.emplace_back(root, false);
+		while (!stack.empty()) {
+			auto [id, expanded] = stack.back();
+			stack.pop_back();
+			if (imported.count(id)) continue;
+			const BddDump::node_t *node = dump.Find(id);
+			if (expanded) {
+				imported[id] = manager.ite(variables[node->var], imported.at(node->high), imported.at(node->low));
+				continue;
+			}
+			stack.emplace_back(id, true);
+			for (uint64_t child : {node->high, node->low}) {
+				if (dump.Find(child) == nullptr) {
+					throw std::runtime_error("node " + std::to_string(id) + " refers to the missing node " +
+					                         std::to_string(child));
+				}
+				if (!imported.count(child)) stack.emplace_back(child, false);
+			}
+		}
+		roots.push_back(imported.at(root));
+	}
+	return roots;
+}
+
+std::vector<std::pair<std::string, bool>> SatisfyingPath(ClassProject::ManagerInterface &manager, ClassProject::BDD_ID f) {
+	std::vector<std::pair<std::string, bool>> path;
+	while (!manager.isConstant(f)) {
+		bool high = manager.coFactorFalse(f) == manager.False();
+		path.emplace_back(manager.getTopVarName(f), high);
+		f = high ? manager.coFactorTrue(f) : manager.coFactorFalse(f);
+	}
+	return path;
+}
+
+bool IsCanonicallyEquivalent(const BddDump &first, const BddDump &second, counterexample_t &counterexample) {
+	if (first.Roots().size() != second.Roots().size()) {
+		return false;
+	}
+	ClassProject::Manager manager;
+	std::vector<ClassProject::BDD_ID> first_roots = ImportDump(manager, first);
+	std::vector<ClassProject::BDD_ID> second_roots = ImportDump(manager, second);
+	for (size_t root = 0; root < first_roots.size(); ++root) {
+		if (first_roots[root] != second_roots[root]) {
+			counterexample = Distinguish(manager, first_roots[root], second_roots[root], root);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CheckCircuitEquivalence(const std::shared_ptr<ClassProject::ManagerInterface> &manager, const Circuit &first,
+                             const Circuit &second, circuit_mismatch_t &mismatch, size_t &compared,
+                             decomposition_t decomposition) {
+	/* Outputs and flip flops of the second circuit, by label */
+	std::map<std::string, gate_t> second_outputs;
+	for (gate_t output : second.Outputs()) {
+		second_outputs.emplace(std::string(second.Label(output)), output);
+	}
+	std::vector<std::pair<gate_t, gate_t>> pairs;
+	for (gate_t output : first.Outputs()) {
+		auto found = second_outputs.find(std::string(first.Label(output)));
+		if (found == second_outputs.end() || second.Type(found->second) != first.Type(output)) {
+			mismatch.unmatched.emplace_back(first.Label(output));
+		} else {
+			pairs.emplace_back(output, found->second);
+			second_outputs.erase(found);
+		}
+	}
+	for (const auto &output : second_outputs) {
+		mismatch.unmatched.push_back(output.first);
+	}
+	compared = 0;
+	if (!mismatch.unmatched.empty()) {
+		return false;
+	}
+
+	/* Both builders share the manager, so equal sub-functions are built once */
+	CircuitToBDD first_builder(manager), second_builder(manager);
+	first_builder.SetDecomposition(decomposition);
+	second_builder.SetDecomposition(decomposition);
+	for (const auto &pair : pairs) {
+		ClassProject::BDD_ID f = first_builder.BuildCone(first, first.Fanins(pair.first)[0]);
+		ClassProject::BDD_ID g = second_builder.BuildCone(second, second.Fanins(pair.second)[0]);
+		if (f != g) {
+			mismatch.output = std::string(first.Label(pair.first));
+			mismatch.counterexample = Distinguish(*manager, f, g, compared);
+			return false;
+		}
+		compared++;
+	}
+	return true;
+}
+
+namespace {
+	/* Loads and compares one actual dump with its expected counterpart */
+	void VerifyDump(const std::string &actual_path, const std::string &expected_path, dump_result_t &result) {
+		auto start = std::chrono::steady_clock::now();
+		if (!std::filesystem::exists(expected_path)) {
+			result.verdict = dump_verdict_t::Missing;
+			result.message = "Missing expected file: " + expected_path;
+		} else {
+			try {
+				BddDump actual(actual_path);
+				BddDump expected(expected_path);
+				result.verdict = IsEquivalent(actual, expected) ? dump_verdict_t::Equivalent
+				                                                : dump_verdict_t::NotEquivalent;
+			} catch (const std::exception &error) {
+				result.verdict = dump_verdict_t::Error;
+				result.message = error.what();
+			}
+		}
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+std::vector<dump_result_t> VerifyDumps(const std::string &actual_dir, const std::string &expected_dir,
+                                       unsigned threads) {
+	if (!std::filesystem::is_directory(actual_dir)) {
+		throw std::runtime_error("invalid directory: " + actual_dir);
+	}
+	std::vector<dump_result_t> results;
+	for (const auto &entry : std::filesystem::directory_iterator(actual_dir)) {
+		if (entry.path().extension() == ".txt") {
+			results.emplace_back();
+			results.back().filename = entry.path().filename().string();
+		}
+	}
+	std::sort(results.begin(), results.end(),
+	          [](const dump_result_t &a, const dump_result_t &b) { return a.filename < b.filename; });
+
+	std::atomic<size_t> next{0};
+	auto worker = [&]() {
+		for (size_t i = next++; i < results.size(); i = next++) {
+			VerifyDump(actual_dir + "/" + results[i].filename, expected_dir + "/" + results[i].filename, results[i]);
+		}
+	};
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < std::min<size_t>(std::max(1u, threads), results.size()); ++t) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (auto &thread : pool) {
+		thread.join();
+	}
+	return results;
+}
+
+int VerifyExitStatus(const std::vector<dump_result_t> &results) {
+	if (results.empty()) {
+		return 1;
+	}
+	for (const auto &result : results) {
+		if (result.verdict != dump_verdict_t::Equivalent) {
+			return 1;
+		}
+	}
+	return 0;
+}
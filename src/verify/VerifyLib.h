@@ -0,0 +1,197 @@
+/*=============================================================================
+    Reading and comparing the txt dumps written by CircuitToBDD::PrintBDD
+=============================================================================*/
+
+#ifndef VERIFYLIB_H_
+#define VERIFYLIB_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../ManagerInterface.h"
+#include "../bench/CircuitToBDD.hpp"
+
+/**
+ * \class BddDump
+ *
+ * \brief The nodes of a txt dump, indexed by their 64 bit IDs.
+ *
+ *  A file holds one or more BDDs of the same manager. Its roots are the
+ *   nodes no other node of the file refers to, in the order they appear in
+ *   the file. Variable names are interned, so every node only stores the
+ *   index of its name.
+ */
+class BddDump {
+
+public:
+
+	struct node_t {
+		uint32_t var;    ///< Index into VarNames(); unused for terminals
+		uint64_t low;
+		uint64_t high;
+	};
+
+	/**
+	 * \brief Reads a txt dump
+	 * \param txt_file the file to read
+	 *
+	 *  Throws std::runtime_error if the file cannot be read or a line is malformed.
+	 */
+	explicit BddDump(const std::string &txt_file);
+
+	static bool IsTerminal(uint64_t id) { return id < 2; }
+
+	/**
+	 * \brief Returns the node with the given ID, or nullptr if the file has none
+	 */
+	const node_t *Find(uint64_t id) const;
+
+	const std::vector<uint64_t> &Roots() const { return roots; }
+
+	const std::vector<std::string> &VarNames() const { return var_names; }
+
+	/**
+	 * \brief Returns the top variable ID the dump gives each name in VarNames()
+	 *
+	 *  The IDs follow the variable order of the manager that wrote the dump.
+	 */
+	const std::vector<uint64_t> &VarIds() const { return var_ids; }
+
+	size_t Size() const { return index_of_id.size(); }
+
+private:
+
+	std::unordered_map<uint64_t, uint32_t> index_of_id;
+	std::vector<node_t> nodes;
+	std::vector<std::string> var_names;
+	std::vector<uint64_t> var_ids;
+	std::vector<uint64_t> roots;
+};
+
+/**
+ * \brief Checks that two dumps hold the same BDDs
+ * \param first the dump to check
+ * \param second the dump it should match
+ * \return true if both have as many roots and each root of first is the
+ *         same BDD as the root of second at the same position
+ *
+ *  Nodes are compared by variable name and children, so the variable orders
+ *   of both managers must agree. Every pair of nodes is compared once, even if
+ *   it is reached along many paths, and the check stops at the first difference.
+ */
+bool IsEquivalent(const BddDump &first, const BddDump &second);
+
+/**
+ * \brief Rebuilds the BDDs of a dump in a manager
+ * \param manager the manager to build in
+ * \param dump the dump to import
+ * \return the IDs in manager of dump.Roots(), in the same order
+ *
+ *  Variables are matched by name. Missing ones are created in the order of
+ *   their IDs in the dump, so a dump imported into an empty manager keeps its
+ *   variable order. Throws std::runtime_error if a node refers to a child the
+ *   file does not contain.
+ */
+std::vector<ClassProject::BDD_ID> ImportDump(ClassProject::ManagerInterface &manager, const BddDump &dump);
+
+/**
+ * \brief An input assignment under which two BDDs differ
+ */
+struct counterexample_t {
+	size_t root = 0;                                      ///< Position of the differing roots
+	std::vector<std::pair<std::string, bool>> assignment; ///< Values of some variables, top first; all others are 0
+	bool first_value = false;                             ///< Value of the first dump; the second has the other
+};
+
+/**
+ * \brief Finds a path from f to the 1 terminal
+ * \param manager the manager f belongs to
+ * \param f a BDD other than False
+ * \return the variable names and values along the path, top first
+ *
+ *  At every node the low edge is taken unless it leads to 0, so the path
+ *   sets as many variables to 0 as possible. Variables not on the path may
+ *   take any value.
+ */
+std::vector<std::pair<std::string, bool>> SatisfyingPath(ClassProject::ManagerInterface &manager, ClassProject::BDD_ID f);
+
+/**
+ * \brief Checks that two dumps hold the same functions by importing both into one manager
+ * \param first the dump to check
+ * \param second the dump it should match
+ * \param counterexample receives the first differing roots and an input assignment
+ *        distinguishing them, unless the dumps have different numbers of roots
+ * \return true if both have as many roots and the roots at each position have the same ID
+ *
+ *  Unlike IsEquivalent, the variable orders of the managers that wrote the
+ *   dumps may differ; the second dump is then reordered by ite calls.
+ */
+bool IsCanonicallyEquivalent(const BddDump &first, const BddDump &second, counterexample_t &counterexample);
+
+/**
+ * \brief Why two circuits are not equivalent
+ */
+struct circuit_mismatch_t {
+	std::vector<std::string> unmatched; ///< Outputs and flip flops only one of the circuits has
+	std::string output;                 ///< The first output whose functions differ, if all are matched
+	counterexample_t counterexample;    ///< Distinguishes the functions of output
+};
+
+/**
+ * \brief Checks that two circuits compute the same outputs and next states
+ * \param manager the manager to build both circuits in
+ * \param first the first circuit
+ * \param second the second circuit
+ * \param mismatch receives the reason if they are not equivalent
+ * \param compared receives the number of outputs and flip flops found equal
+ * \param decomposition how both circuits split gates with more than two inputs
+ * \return true if both have the same outputs and flip flops, by label, with equal functions
+ *
+ *  Inputs, and the current states of flip flops, are matched by label. The
+ *   outputs are compared one at a time in the order of first: the cone of
+ *   the output is built in both circuits, reusing the gates built for earlier
+ *   cones, and the two BDD IDs are compared. The check stops at the first
+ *   output that differs, leaving the cones of later outputs unbuilt.
+ */
+bool CheckCircuitEquivalence(const std::shared_ptr<ClassProject::ManagerInterface> &manager, const Circuit &first,
+                             const Circuit &second, circuit_mismatch_t &mismatch, size_t &compared,
+                             decomposition_t decomposition = decomposition_t::Linear);
+
+/**
+ * \brief Outcome of comparing one dump with its expected counterpart
+ */
+enum class dump_verdict_t { Equivalent, NotEquivalent, Missing, Error };
+
+struct dump_result_t {
+	std::string filename;                             ///< Name of the dump, the same in both directories
+	dump_verdict_t verdict = dump_verdict_t::Error;
+	std::string message;                              ///< Why the file was not compared
+	double seconds = 0;                               ///< Time to load and compare both files
+};
+
+/**
+ * \brief Compares every .txt dump of a directory with the file of the same name in another one
+ * \param actual_dir the directory of the dumps to check
+ * \param expected_dir the directory of the dumps they should match
+ * \param threads the most threads to compare files with at once
+ * \return one result per dump of actual_dir, sorted by file name
+ *
+ *  The files are compared with IsEquivalent by a pool of threads, each
+ *   taking the next file. A dump without an expected counterpart is Missing,
+ *   one that cannot be read is an Error. Throws std::runtime_error if
+ *   actual_dir is not a directory.
+ */
+std::vector<dump_result_t> VerifyDumps(const std::string &actual_dir, const std::string &expected_dir,
+                                       unsigned threads);
+
+/**
+ * \brief Exit status of VDSProject_verify_all for the results of VerifyDumps
+ * \return 0 if at least one file was compared and every file is equivalent, 1 otherwise
+ */
+int VerifyExitStatus(const std::vector<dump_result_t> &results);
+
+#endif /* VERIFYLIB_H_ */
@@ -2,129 +2,59 @@
     Written by Mohammad R Fadiheh (2017)
 =============================================================================*/
 
-#include<iostream>
-#include<fstream>
-#include<string>
-#include<sstream>
-#include<map>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 
-struct node {
-	std::string var_name;
-	int low;
-	int high;
-};
-
-typedef std::map<int, node> uniqueTable;
-
-bool isEquivalent(const uniqueTable &BDD1, const uniqueTable &BDD2, int root1, int root2)
-{
-	if(BDD1.find(root1) == BDD1.end() || BDD2.find(root2) == BDD2.end())
-		return false;
-	if(root1 == 1 && root2 == 1)
-		return true;
-	if(root1 == 0 && root2 == 0)
-		return true;
-	if(root1 != root2 && ( (root1 == 0 || root1 == 1) || (root2 == 0 || root2 == 1) ) )
-		return false;
-	if(BDD1.at(root1).var_name != BDD2.at(root2).var_name)
-		return false;
-    return isEquivalent(BDD1, BDD2, BDD1.at(root1).low, BDD2.at(root2).low) and isEquivalent(BDD1, BDD2, BDD1.at(root1).high, BDD2.at(root2).high);
-}
+#include "VerifyLib.h"
 
 int main(int argc, char* argv[])
 {
+	bool canonical = argc > 1 && std::string(argv[1]) == "--canonical";
+	int first_file = canonical ? 2 : 1;
 
 	/* Number of arguments validation */
-	if (3 > argc)
+	if (first_file + 2 > argc)
 	{
 		std::cout << "Must specify a filename!" << std::endl;
+		std::cout << "Usage: " << argv[0] << " [--canonical] <bdd1.txt> <bdd2.txt>" << std::endl;
 		return -1;
 	}
-	
-	uniqueTable BDD1, BDD2;
 
-	std::string BDD1_file = argv[1];
-	std::string BDD2_file = argv[2];
-
-	std::ifstream BDD1_if(BDD1_file.c_str());
-	std::ifstream BDD2_if(BDD2_file.c_str());
-
-	if(!BDD1_if.is_open() || !BDD2_if.is_open())
+	try
 	{
-		std::cout << "invalid file!" << std::endl;
-		return -1;
-	}
-
-	std::stringstream ss;
-
-	std::string temp;
-	std::string var_name;
-	int id, top_var;
+		BddDump BDD1(argv[first_file]);
+		BddDump BDD2(argv[first_file + 1]);
 
-	while(!BDD1_if.eof())
-	{
-		node n;			
-		temp.clear();
-		std::getline(BDD1_if, temp,'\n');
-
-		if(temp.find("Terminal Node: 1") != std::string::npos)
+		/* --canonical imports both dumps into one manager, so equal functions get equal IDs */
+		counterexample_t counterexample;
+		bool equivalent = canonical ? IsCanonicallyEquivalent(BDD1, BDD2, counterexample) : IsEquivalent(BDD1, BDD2);
+		if (equivalent)
 		{
-			n.var_name = "";
-			n.low = 1;
-			n.high = 1;
-			BDD1.insert(std::pair<int,node>(1,n));
+			std::cout << "Equivalent!" << std::endl;
+			return 0;
 		}
-		else if(temp.find("Terminal Node: 0") != std::string::npos)
+		std::cout << "Not Equivalent!" << std::endl;
+		if (canonical && BDD1.Roots().size() != BDD2.Roots().size())
 		{
-			n.var_name = "";
-			n.low = 0;
-			n.high = 0;
-			BDD1.insert(std::pair<int,node>(0,n));
-
+			std::cout << "The files hold " << BDD1.Roots().size() << " and " << BDD2.Roots().size()
+			          << " BDDs" << std::endl;
 		}
-		else if(temp.find("Variable Node:") != std::string::npos)
+		else if (canonical)
 		{
-			ss.clear();
-			ss.str(temp);
-			ss>>temp>>temp>>id>>temp>>temp>>temp>>top_var>>temp>>temp>>temp>>n.var_name>>temp>>n.low>>temp>>n.high;
-			BDD1.insert(std::pair<int,node>(id,n));
+			std::cout << "Root " << counterexample.root << " is " << counterexample.first_value << " in the first and "
+			          << !counterexample.first_value << " in the second file for:";
+			for (const auto &value : counterexample.assignment)
+			{
+				std::cout << " " << value.first << "=" << value.second;
+			}
+			std::cout << " (all other variables 0)" << std::endl;
 		}
+		return 1;
 	}
-
-	while(!BDD2_if.eof())
+	catch (const std::runtime_error &error)
 	{
-		node n;			
-		temp.clear();
-		std::getline(BDD2_if, temp,'\n');
-
-		if(temp.find("Terminal Node: 1") != std::string::npos)
-		{
-			n.var_name = "";
-			n.low = 1;
-			n.high = 1;
-			BDD2.insert(std::pair<int,node>(1,n));
-		}
-		else if(temp.find("Terminal Node: 0") != std::string::npos)
-		{
-			n.var_name = "";
-			n.low = 0;
-			n.high = 0;
-			BDD2.insert(std::pair<int,node>(0,n));
-
-		}
-		else if(temp.find("Variable Node:") != std::string::npos)
-		{
-			ss.clear();
-			ss.str(temp);
-			ss>>temp>>temp>>id>>temp>>temp>>temp>>top_var>>temp>>temp>>temp>>n.var_name>>temp>>n.low>>temp>>n.high;
-			BDD2.insert(std::pair<int,node>(id,n));
-		}
+		std::cout << error.what() << std::endl;
+		return -1;
 	}
-
-	if( isEquivalent(BDD1, BDD2, BDD1.rbegin()->first, BDD2.rbegin()->first) )
-		std::cout<<"Equivalent!"<<std::endl;
-	else
-		std::cout<<"Not Equivalent!"<<std::endl;
-	return 0;
 }
-
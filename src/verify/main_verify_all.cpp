@@ -1,48 +1,68 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
-#include <filesystem>
+#include <stdexcept>
 #include <string>
-#include <unistd.h>  // for readlink
-#include <limits.h>  // for PATH_MAX
+#include <thread>
+#include <vector>
 
-namespace fs = std::filesystem;
+#include "VerifyLib.h"
 
-std::string get_executable_dir() {
-	char result[PATH_MAX];
-	ssize_t count = readlink("/proc/self/exe", result, PATH_MAX);
-	if (count == -1) {
-		throw std::runtime_error("Failed to get executable path");
+int main(int argc, char *argv[]) {
+	if (argc < 2 || argc > 4) {
+		std::cout << "Usage: " << argv[0] << " <circuit> [actual_dir] [expected_dir]" << std::endl;
+		std::cout << "  defaults: results_<circuit>/txt and results/results_<circuit>/txt" << std::endl;
+		return -1;
 	}
-	std::string path(result, count);
-	return fs::path(path).parent_path().string();
-}
-
-int main() {
-	std::string actual_dir = "results_c3540/txt";
-	std::string expected_dir = "results/results_c3540/txt";
-
-	std::string bin_dir = get_executable_dir();
-	std::string verify_bin = bin_dir + "/VDSProject_verify";
-
-	for (const auto& entry : fs::directory_iterator(actual_dir)) {
-		if (entry.path().extension() == ".txt") {
-			std::string filename = entry.path().filename().string();
-			std::string actual_path = entry.path().string();
-			std::string expected_path = expected_dir + "/" + filename;
+	std::string circuit = argv[1];
+	std::string actual_dir = argc > 2 ? argv[2] : "results_" + circuit + "/txt";
+	std::string expected_dir = argc > 3 ? argv[3] : "results/results_" + circuit + "/txt";
 
-			std::cout << "Verifying: " << filename << std::endl;
+	/* Files are compared in this process by a pool of threads, each taking the next file */
+	auto wall_start = std::chrono::steady_clock::now();
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<dump_result_t> results;
+	try {
+		results = VerifyDumps(actual_dir, expected_dir, threads);
+	} catch (const std::runtime_error &error) {
+		std::cout << error.what() << std::endl;
+		return -1;
+	}
+	double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
 
-			if (fs::exists(expected_path)) {
-				std::string command = "\"" + verify_bin + "\" \"" + actual_path + "\" \"" + expected_path + "\"";
-				int ret = std::system(command.c_str());
-				if (ret != 0) {
-					std::cerr << "Not equivalent: " << filename << "\n";
-				}
-			} else {
-				std::cerr << "Missing expected file: " << expected_path << "\n";
-			}
+	size_t counts[4] = {0, 0, 0, 0};
+	double summed_time = 0;
+	for (const auto &result : results) {
+		counts[static_cast<size_t>(result.verdict)]++;
+		summed_time += result.seconds;
+		std::cout << "Verifying: " << result.filename << " ... ";
+		switch (result.verdict) {
+			case dump_verdict_t::Equivalent:
+				std::cout << "Equivalent!";
+				break;
+			case dump_verdict_t::NotEquivalent:
+				std::cout << "Not Equivalent!";
+				break;
+			case dump_verdict_t::Missing:
+			case dump_verdict_t::Error:
+				std::cout << result.message;
+				break;
 		}
+		std::cout << " (" << std::fixed << std::setprecision(4) << result.seconds << " s)" << std::endl;
+	}
+	if (results.empty()) {
+		std::cout << "No .txt dumps found in " << actual_dir << std::endl;
 	}
 
-	return 0;
-}
+	std::cout << std::endl << "**** Summary: " << circuit << " ****" << std::endl;
+	std::cout << " Files: " << results.size() << std::endl;
+	std::cout << " Equivalent: " << counts[static_cast<size_t>(dump_verdict_t::Equivalent)] << std::endl;
+	std::cout << " Not equivalent: " << counts[static_cast<size_t>(dump_verdict_t::NotEquivalent)] << std::endl;
+	std::cout << " Missing expected: " << counts[static_cast<size_t>(dump_verdict_t::Missing)] << std::endl;
+	std::cout << " Unreadable: " << counts[static_cast<size_t>(dump_verdict_t::Error)] << std::endl;
+	std::cout << " Time: " << wall_time << " s wall, " << summed_time << " s summed over files, "
+	          << std::min<size_t>(threads, results.size()) << " threads" << std::endl;
 
+	return VerifyExitStatus(results);
+}